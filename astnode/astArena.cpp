@@ -0,0 +1,43 @@
+#include "parser/astnodes/astArena.hpp"
+
+static thread_local astArena *installed = nullptr;
+
+astArena::~astArena() {
+    for(char *block : blocks) {
+        ::operator delete(block);
+    }
+}
+
+void astArena::grow(size_t size) {
+    size_t bytes = std::max(size, blockSize);
+    char *block = (char *)::operator new(bytes);
+    blocks.push_back(block);
+    cur = block;
+    end = block + bytes;
+}
+
+void astArena::adopt(astArena &other) {
+    blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+    used += other.used;
+    other.blocks.clear();
+    other.cur = other.end = nullptr;
+    other.used = 0;
+}
+
+astArena &astArena::current() {
+    if(installed == nullptr) {
+        // never freed, as nodes allocated here may be referenced until exit
+        static thread_local astArena *fallback = new astArena();
+        return *fallback;
+    }
+    return *installed;
+}
+
+astArena::scope::scope(astArena &arena)
+: previous(installed) {
+    installed = &arena;
+}
+
+astArena::scope::~scope() {
+    installed = previous;
+}
@@ -0,0 +1,468 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include "parser/astnodes/astCache.hpp"
+#include "parser/parser.hpp"
+
+/*
+    A type record is its TypeKind, is_const and size, followed by
+        Array       element type, number of dims, dims
+        Pointer     element type, depth
+        Function    return type, number of arguments, argument types,
+                    number of bindings, binding names
+        ClassVar    class name
+    and nothing for the primitive kinds. A record only refers to types before it. All
+    but function types are read back as their canonical TypeFactory instance.
+*/
+
+struct entryWriter {
+    public:
+        void word(uint32_t v) { out.append((const char *)&v, sizeof(v)); }
+        void bytes(const void *data, size_t size) { out.append((const char *)data, size); }
+        template <typename T>
+        void column(const std::vector<T> &v) {
+            word(uint32_t(v.size()));
+            bytes(v.data(), v.size() * sizeof(T));
+        }
+    public:
+        std::string out;
+};
+
+struct entryReader {
+    public:
+        uint32_t word() {
+            uint32_t v = 0;
+            bytes(&v, sizeof(v));
+            return v;
+        }
+        void bytes(void *data, size_t size) {
+            if(size_t(end - pos) < size) {
+                ok = false;
+                return;
+            }
+            memcpy(data, pos, size);
+            pos += size;
+        }
+        // A count of items of at least itemSize bytes, which must all fit in what is left.
+        size_t count(size_t itemSize) {
+            size_t n = word();
+            if(!ok || n > size_t(end - pos) / itemSize) {
+                ok = false;
+                return 0;
+            }
+            return n;
+        }
+        template <typename T>
+        void column(std::vector<T> &v) {
+            v.resize(count(sizeof(T)));
+            bytes(v.data(), v.size() * sizeof(T));
+        }
+    public:
+        const char *pos, *end;
+        bool ok = true;
+};
+
+// Assigns the names and types of an entry their indices and writes the type records.
+struct entryEncoder {
+    public:
+        entryEncoder() : types{nullptr} { typeIndex[nullptr] = 0; }
+
+        uint32_t name(symId id) {
+            auto found = nameIndex.find(id);
+            if(found != nameIndex.end()) return found->second;
+            names.push_back(id);
+            return nameIndex[id] = uint32_t(names.size() - 1);
+        }
+
+        uint32_t type(struct Type *t) {
+            auto found = typeIndex.find(t);
+            if(found != typeIndex.end()) return found->second;
+            entryWriter record;
+            record.word(t->kind);
+            record.word(t->is_const);
+            record.word(uint32_t(t->size));
+            switch(t->kind) {
+                case TypeKind::Int: case TypeKind::Bool: case TypeKind::Char:
+                case TypeKind::Float: case TypeKind::Void:
+                    break;
+                case TypeKind::Array: {
+                    ArrayType *a = static_cast<ArrayType *>(t);
+                    if(!a->pendingDims.empty() || a->element_type == nullptr) ok = false;
+                    record.word(type(a->element_type));
+                    record.word(uint32_t(a->dims.size()));
+                    for(size_t dim : a->dims) record.word(uint32_t(dim));
+                    break;
+                }
+                case TypeKind::Pointer: {
+                    PointerType *p = static_cast<PointerType *>(t);
+                    if(p->elementType == nullptr) ok = false;
+                    record.word(type(p->elementType));
+                    record.word(uint32_t(p->depth));
+                    break;
+                }
+                case TypeKind::Function: {
+                    FuncType *f = static_cast<FuncType *>(t);
+                    record.word(type(f->retType));
+                    record.word(uint32_t(f->argTypeList.size()));
+                    for(struct Type *arg : f->argTypeList) record.word(type(arg));
+                    record.word(uint32_t(f->bindings.size()));
+                    for(symId binding : f->bindings) record.word(name(binding));
+                    break;
+                }
+                case TypeKind::ClassVar:
+                    record.word(name(static_cast<ClassVarType *>(t)->classSym));
+                    break;
+                default:
+                    // classes carry their scopes, and errors are never cached
+                    ok = false;
+                    return 0;
+            }
+            records.bytes(record.out.data(), record.out.size());
+            types.push_back(t);
+            return typeIndex[t] = uint32_t(types.size() - 1);
+        }
+
+    public:
+        std::vector<symId> names;
+        std::vector<struct Type *> types;
+        entryWriter records;
+        bool ok = true;
+
+    private:
+        std::unordered_map<symId, uint32_t> nameIndex;
+        std::unordered_map<struct Type *, uint32_t> typeIndex;
+};
+
+static bool hasName(flatKind kind) {
+    switch(kind) {
+        case FLAT_IDENTIFIER: case FLAT_FUN_CALL: case FLAT_FUNC_DEF: case FLAT_VAR_DEF:
+        case FLAT_VAR_DECL: case FLAT_CLASS_DEF: case FLAT_MEMBER_ACCESS: case FLAT_POINTER_ACC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The slot other than `types` that holds a type index, or nullptr.
+static std::vector<uint32_t> *typeSlot(flatAST &ast, flatKind kind) {
+    if(kind == FLAT_SUBSCRIPT) return &ast.third;
+    if(kind == FLAT_TYPE_CAST) return &ast.second;
+    return nullptr;
+}
+
+// The slots of a node of kind (1 first, 2 second, 4 third) that hold a child handle, which
+// may be noNode.
+static uint8_t childSlots(flatKind kind) {
+    switch(kind) {
+        case FLAT_UNARY: case FLAT_EXPR_STMT: case FLAT_RETURN: case FLAT_INIT_VAL: case FLAT_TYPE_CAST:
+            return 1;
+        case FLAT_BINARY: case FLAT_SUBSCRIPT: case FLAT_WHILE:
+            return 1 | 2;
+        case FLAT_IF_ELSE:
+            return 1 | 2 | 4;
+        case FLAT_VAR_DEF: case FLAT_MEMBER_ACCESS: case FLAT_POINTER_ACC:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+// The slots of a node of kind that hold the offset of a child list.
+static uint8_t listSlots(flatKind kind) {
+    switch(kind) {
+        case FLAT_PROGRAM: case FLAT_BLOCK:
+            return 1;
+        case FLAT_FUN_CALL: case FLAT_FUNC_DEF: case FLAT_VAR_DECL: case FLAT_INIT_VAL: case FLAT_CLASS_DEF:
+            return 2;
+        case FLAT_MEMBER_ACCESS: case FLAT_POINTER_ACC:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+static struct Type *readType(entryReader &in, const std::vector<struct Type *> &types,
+                             const std::vector<symId> &names) {
+    auto typeAt = [&](uint32_t index) -> struct Type * {
+        if(index >= types.size()) in.ok = false;
+        return in.ok ? types[index] : nullptr;
+    };
+    // an array or pointer needs an element type, read before it as its parts are
+    auto elementAt = [&](uint32_t index) -> struct Type * {
+        struct Type *element = typeAt(index);
+        if(element == nullptr) in.ok = false;
+        return element;
+    };
+    auto nameAt = [&](uint32_t index) -> symId {
+        if(index >= names.size()) in.ok = false;
+        return in.ok ? names[index] : 0;
+    };
+    uint32_t kind = in.word();
+    bool isConst = in.word() != 0;
+    size_t size = in.word();
+    struct Type *t = nullptr;
+    switch(kind) {
+        case TypeKind::Int: t = TypeFactory::getInt(); break;
+        case TypeKind::Bool: t = TypeFactory::getBool(); break;
+        case TypeKind::Char: t = TypeFactory::getChar(); break;
+        case TypeKind::Float: t = TypeFactory::getFloat(); break;
+        case TypeKind::Void: t = TypeFactory::getVoid(); break;
+        case TypeKind::Array: {
+            ArrayType a;
+            a.element_type = elementAt(in.word());
+            uint32_t count = in.word();
+            for(uint32_t i = 0; i < count && in.ok; i++) a.dims.push_back(in.word());
+            a.size = size;
+            a.is_const = isConst;
+            return in.ok ? TypeFactory::canonical(&a) : nullptr;
+        }
+        case TypeKind::Pointer: {
+            PointerType p;
+            p.elementType = elementAt(in.word());
+            p.depth = in.word();
+            p.size = size;
+            p.is_const = isConst;
+            return in.ok ? TypeFactory::canonical(&p) : nullptr;
+        }
+        case TypeKind::Function: {
+            FuncType *f = TypeFactory::getFunction();
+            f->retType = typeAt(in.word());
+            uint32_t count = in.word();
+            for(uint32_t i = 0; i < count && in.ok; i++) f->argTypeList.push_back(typeAt(in.word()));
+            count = in.word();
+            for(uint32_t i = 0; i < count && in.ok; i++) f->bindings.push_back(nameAt(in.word()));
+            f->size = size;
+            f->is_const = isConst;
+            return f;
+        }
+        case TypeKind::ClassVar: {
+            ClassVarType c(std::string(Interner::spelling(nameAt(in.word()))));
+            c.size = size;
+            c.is_const = isConst;
+            return in.ok ? TypeFactory::canonical(&c) : nullptr;
+        }
+        default:
+            in.ok = false;
+            return nullptr;
+    }
+    return isConst ? TypeFactory::getConst(t) : t;
+}
+
+uint64_t sourceHash(std::string_view text) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t compilerBuildId() {
+    static const uint64_t id = [] {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto mix = [&hash](uint64_t v) {
+            hash ^= v;
+            hash *= 0x100000001b3ull;
+        };
+        mix(astCacheVersion);
+        mix(grammarHash(parserRules));
+        struct stat st;
+        if(stat("/proc/self/exe", &st) == 0) {
+            mix(uint64_t(st.st_size));
+            mix(uint64_t(st.st_mtim.tv_sec));
+            mix(uint64_t(st.st_mtim.tv_nsec));
+        }
+        return hash;
+    }();
+    return id;
+}
+
+astCache::astCache(const std::string &dir)
+: dir(dir) {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+}
+
+std::string astCache::entryPath(std::string_view source) const {
+    std::stringstream name;
+    name << dir << "/ast-" << std::hex << std::setw(16) << std::setfill('0') << sourceHash(source) << ".bin";
+    return name.str();
+}
+
+void astCache::record(bool hit) {
+    // one byte per lookup; appends this small are atomic, so compilers can share the file
+    int fd = open((dir + "/ast-stats").c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if(fd < 0) return;
+    char c = hit ? 'h' : 'm';
+    if(write(fd, &c, 1) != 1) {
+        // statistics are best effort
+    }
+    close(fd);
+}
+
+nodePtr astCache::load(std::string_view source) {
+    std::ifstream file(entryPath(source), std::ios::binary);
+    std::string data;
+    if(file.is_open()) data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    entryReader in{data.data(), data.data() + data.size()};
+    astCacheHeader header;
+    in.bytes(&header, sizeof(header));
+    if(!in.ok || memcmp(header.magic, astCacheMagic, sizeof(astCacheMagic)) != 0
+        || header.version != astCacheVersion || header.buildId != compilerBuildId()
+        || header.sourceHash != sourceHash(source) || header.sourceSize != source.size()) {
+        misses++;
+        record(false);
+        return nullptr;
+    }
+
+    std::vector<symId> names(in.count(sizeof(uint32_t)));
+    for(size_t i = 0; i < names.size() && in.ok; i++) {
+        std::string spelling(in.count(1), '\0');
+        in.bytes(spelling.data(), spelling.size());
+        names[i] = Interner::intern(spelling);
+    }
+    flatAST flat;
+    uint32_t typeCount = in.word();
+    for(uint32_t i = 1; i < typeCount && in.ok; i++) {
+        flat.typeTable.push_back(readType(in, flat.typeTable, names));
+    }
+    in.column(flat.kinds);
+    in.column(flat.ops);
+    in.column(flat.flags);
+    in.column(flat.lines);
+    in.column(flat.columns);
+    in.column(flat.first);
+    in.column(flat.second);
+    in.column(flat.third);
+    in.column(flat.types);
+    in.column(flat.lists);
+    uint32_t errorCount = in.word();
+    for(uint32_t i = 0; i < errorCount && in.ok; i++) {
+        astHandle n = in.word();
+        std::string message(in.count(1), '\0');
+        in.bytes(message.data(), message.size());
+        flat.errors[n] = message;
+    }
+    astHandle root = in.word();
+
+    // Entries are only ever replaced whole, so this guards against damaged files and files
+    // from elsewhere: everything toTree reads must be in range. Children come after their
+    // parent in preorder, so a child handle must be greater than its parent's, which also
+    // rules out cycles.
+    size_t count = flat.kinds.size();
+    bool consistent = in.ok && in.pos == in.end && root < count
+        && flat.ops.size() == count && flat.flags.size() == count;
+    for(auto *column : {&flat.lines, &flat.columns, &flat.first, &flat.second, &flat.third, &flat.types}) {
+        consistent = consistent && column->size() == count;
+    }
+    std::vector<uint32_t> *slots[] = {&flat.first, &flat.second, &flat.third};
+    for(size_t n = 0; consistent && n < count; n++) {
+        auto isChild = [&](astHandle child) { return child == noNode || (child > n && child < count); };
+        if(flat.kinds[n] > FLAT_TYPE_CAST || flat.types[n] >= flat.typeTable.size()) {
+            consistent = false;
+            break;
+        }
+        for(int s = 0; s < 3; s++) {
+            uint32_t value = (*slots[s])[n];
+            if((childSlots(flat.kinds[n]) & (1 << s)) && !isChild(value)) consistent = false;
+            if(!(listSlots(flat.kinds[n]) & (1 << s))) continue;
+            if(value >= flat.lists.size() || flat.lists[value] > flat.lists.size() - value - 1) {
+                consistent = false;
+                continue;
+            }
+            for(astHandle child : flat.list(value)) consistent = consistent && isChild(child);
+        }
+        if(hasName(flat.kinds[n])) {
+            if(flat.first[n] >= names.size()) consistent = false;
+            else flat.first[n] = names[flat.first[n]];
+        }
+        std::vector<uint32_t> *slot = typeSlot(flat, flat.kinds[n]);
+        if(slot && (*slot)[n] >= flat.typeTable.size()) consistent = false;
+    }
+    if(!consistent) {
+        misses++;
+        record(false);
+        return nullptr;
+    }
+    hits++;
+    record(true);
+    return flat.toTree(root);
+}
+
+bool astCache::store(std::string_view source, node *root) {
+    flatAST flat;
+    astHandle flatRoot = flat.fromTree(root);
+    entryEncoder encoder;
+    std::vector<uint32_t> typeMap;
+    for(struct Type *t : flat.typeTable) typeMap.push_back(t ? encoder.type(t) : 0);
+    for(size_t n = 0; n < flat.size(); n++) {
+        flat.types[n] = typeMap[flat.types[n]];
+        if(std::vector<uint32_t> *slot = typeSlot(flat, flat.kinds[n])) (*slot)[n] = typeMap[(*slot)[n]];
+        if(hasName(flat.kinds[n])) flat.first[n] = encoder.name(flat.first[n]);
+    }
+    if(!encoder.ok) {
+        uncacheable++;
+        return false;
+    }
+
+    entryWriter out;
+    astCacheHeader header = {};
+    memcpy(header.magic, astCacheMagic, sizeof(astCacheMagic));
+    header.version = astCacheVersion;
+    header.buildId = compilerBuildId();
+    header.sourceHash = sourceHash(source);
+    header.sourceSize = source.size();
+    out.bytes(&header, sizeof(header));
+    out.word(uint32_t(encoder.names.size()));
+    for(symId id : encoder.names) {
+        std::string_view spelling = Interner::spelling(id);
+        out.word(uint32_t(spelling.size()));
+        out.bytes(spelling.data(), spelling.size());
+    }
+    out.word(uint32_t(encoder.types.size()));
+    out.bytes(encoder.records.out.data(), encoder.records.out.size());
+    out.column(flat.kinds);
+    out.column(flat.ops);
+    out.column(flat.flags);
+    out.column(flat.lines);
+    out.column(flat.columns);
+    out.column(flat.first);
+    out.column(flat.second);
+    out.column(flat.third);
+    out.column(flat.types);
+    out.column(flat.lists);
+    out.word(uint32_t(flat.errors.size()));
+    for(const auto &[n, message] : flat.errors) {
+        out.word(n);
+        out.word(uint32_t(message.size()));
+        out.bytes(message.data(), message.size());
+    }
+    out.word(flatRoot);
+
+    std::string path = entryPath(source);
+    std::string tmp = path + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tmp, std::ios::binary);
+    file.write(out.out.data(), out.out.size());
+    file.close();
+    if(!file || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    stores++;
+    return true;
+}
+
+void astCache::printStats(std::ostream &out) const {
+    size_t allHits = 0, allMisses = 0;
+    std::ifstream file(dir + "/ast-stats", std::ios::binary);
+    for(char c; file.get(c);) {
+        if(c == 'h') allHits++;
+        else if(c == 'm') allMisses++;
+    }
+    out << "ast cache " << dir << ": " << hits << " hits, " << misses << " misses, "
+        << stores << " stored, " << uncacheable << " uncacheable; "
+        << allHits << " hits, " << allMisses << " misses in all\n";
+}
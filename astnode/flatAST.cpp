@@ -0,0 +1,407 @@
+#include "parser/astnodes/flatAST.hpp"
+#include "types/constEval.hpp"
+
+static expPtr asExpr(nodePtr n) {
+    return expPtr(static_cast<expr *>(n.release()));
+}
+
+static stmtPtr asStmt(nodePtr n) {
+    return stmtPtr(static_cast<stmt *>(n.release()));
+}
+
+flatAST::flatAST()
+: typeTable{nullptr} {
+    indexOfType[nullptr] = 0;
+}
+
+size_t flatAST::bytes() const {
+    return kinds.capacity() * sizeof(flatKind) + ops.capacity() + flags.capacity()
+         + (lines.capacity() + columns.capacity() + first.capacity() + second.capacity() + third.capacity()
+            + types.capacity() + lists.capacity()) * sizeof(uint32_t)
+         + typeTable.capacity() * sizeof(struct Type *);
+}
+
+void flatAST::shrinkToFit() {
+    kinds.shrink_to_fit();
+    ops.shrink_to_fit();
+    flags.shrink_to_fit();
+    lines.shrink_to_fit();
+    columns.shrink_to_fit();
+    first.shrink_to_fit();
+    second.shrink_to_fit();
+    third.shrink_to_fit();
+    types.shrink_to_fit();
+    lists.shrink_to_fit();
+}
+
+astHandle flatAST::add(flatKind kind, node *from) {
+    if(kinds.size() == noNode) {
+        std::cout << "Too many nodes for the flat AST\n";
+        exit(1);
+    }
+    astHandle n = astHandle(kinds.size());
+    kinds.push_back(kind);
+    ops.push_back(OpKind(0));
+    flags.push_back(0);
+    lines.push_back(uint32_t(from->location.first));
+    columns.push_back(uint32_t(from->location.second));
+    first.push_back(0);
+    second.push_back(0);
+    third.push_back(0);
+    types.push_back(0);
+    if(!from->error_msg.empty()) errors[n] = from->error_msg;
+    if(expr *e = dynamic_cast<expr *>(from)) {
+        setType(n, e->inferred_type);
+        if(e->is_const) flags[n] |= FLAT_CONST;
+    }
+    return n;
+}
+
+// The checker folds only int operations, so the value fits the third slot.
+void flatAST::setFolded(astHandle n, expr *e) {
+    if(e->const_evaluated && e->constant.is_const && e->constant.value.kind == Const_Int) {
+        flags[n] |= FLAT_FOLDED;
+        third[n] = uint32_t(e->constant.value.i);
+    }
+}
+
+uint32_t flatAST::addList(const std::vector<astHandle> &handles) {
+    uint32_t offset = uint32_t(lists.size());
+    lists.push_back(uint32_t(handles.size()));
+    lists.insert(lists.end(), handles.begin(), handles.end());
+    return offset;
+}
+
+uint32_t flatAST::typeIndex(struct Type *type) {
+    auto found = indexOfType.find(type);
+    if(found != indexOfType.end()) return found->second;
+    typeTable.push_back(type);
+    return indexOfType[type] = uint32_t(typeTable.size() - 1);
+}
+
+astHandle flatAST::fromTree(node *root) {
+    if(root == nullptr) return noNode;
+    // Each node is added before its children to keep the preorder. Names are the symIds
+    // the parser stored, except for members and type names, which have none.
+    std::vector<astHandle> items;
+    astHandle n;
+    switch(root->kind) {
+        case Program: {
+            program *p = static_cast<program *>(root);
+            n = add(FLAT_PROGRAM, root);
+            for(node *child : p->children) items.push_back(fromTree(child));
+            first[n] = addList(items);
+            break;
+        }
+        case Int_Literal:
+            n = add(FLAT_INT_LITERAL, root);
+            first[n] = uint32_t(static_cast<int_literal *>(root)->value);
+            break;
+        case Unary_Op: {
+            unary_expr *p = static_cast<unary_expr *>(root);
+            n = add(FLAT_UNARY, root);
+            ops[n] = p->op;
+            setFolded(n, p);
+            first[n] = fromTree(p->operand.get());
+            break;
+        }
+        case Binary_Op: {
+            binary_expr *p = static_cast<binary_expr *>(root);
+            n = add(FLAT_BINARY, root);
+            ops[n] = p->op;
+            setFolded(n, p);
+            first[n] = fromTree(p->left.get());
+            second[n] = fromTree(p->right.get());
+            break;
+        }
+        case Subscript_Expr: {
+            subscript_expr *p = static_cast<subscript_expr *>(root);
+            n = add(FLAT_SUBSCRIPT, root);
+            third[n] = typeIndex(p->base_type);
+            first[n] = fromTree(p->list.get());
+            second[n] = fromTree(p->sub.get());
+            break;
+        }
+        case Identifier:
+            n = add(FLAT_IDENTIFIER, root);
+            first[n] = static_cast<identifier *>(root)->sym;
+            break;
+        case Expr_Stmt:
+            n = add(FLAT_EXPR_STMT, root);
+            first[n] = fromTree(static_cast<expr_stmt *>(root)->ptr.get());
+            break;
+        case IF_ELSE_Stmt: {
+            if_else_stmt *p = static_cast<if_else_stmt *>(root);
+            n = add(FLAT_IF_ELSE, root);
+            first[n] = fromTree(p->cond.get());
+            second[n] = fromTree(p->if_branch.get());
+            third[n] = fromTree(p->else_branch.get());
+            break;
+        }
+        case WHILE_Stmt: {
+            while_stmt *p = static_cast<while_stmt *>(root);
+            n = add(FLAT_WHILE, root);
+            first[n] = fromTree(p->cond.get());
+            second[n] = fromTree(p->body.get());
+            break;
+        }
+        case Break_Stmt:
+            n = add(FLAT_BREAK, root);
+            break;
+        case Continue_Stmt:
+            n = add(FLAT_CONTINUE, root);
+            break;
+        case Return_Stmt:
+            n = add(FLAT_RETURN, root);
+            first[n] = fromTree(static_cast<return_stmt *>(root)->value.get());
+            break;
+        case Block_Stmt: {
+            block_stmt *p = static_cast<block_stmt *>(root);
+            n = add(FLAT_BLOCK, root);
+            for(auto &item : p->items) items.push_back(fromTree(item.get()));
+            first[n] = addList(items);
+            break;
+        }
+        case Fun_Call: {
+            fun_call *p = static_cast<fun_call *>(root);
+            n = add(FLAT_FUN_CALL, root);
+            first[n] = p->func_sym;
+            for(auto &arg : p->args) items.push_back(fromTree(arg.get()));
+            second[n] = addList(items);
+            break;
+        }
+        case Func_Def: {
+            func_def *p = static_cast<func_def *>(root);
+            n = add(FLAT_FUNC_DEF, root);
+            setType(n, p->type);
+            if(p->is_constructor) flags[n] |= FLAT_CTOR;
+            first[n] = p->sym;
+            for(auto &item : p->body) items.push_back(fromTree(item.get()));
+            second[n] = addList(items);
+            break;
+        }
+        case Var_Def: {
+            var_def *p = static_cast<var_def *>(root);
+            n = add(FLAT_VAR_DEF, root);
+            setType(n, p->type);
+            if(p->is_const) flags[n] |= FLAT_CONST;
+            first[n] = p->sym;
+            second[n] = fromTree(p->init_val.get());
+            break;
+        }
+        case Var_Decl: {
+            var_decl *p = static_cast<var_decl *>(root);
+            n = add(FLAT_VAR_DECL, root);
+            if(p->is_const) flags[n] |= FLAT_CONST;
+            first[n] = Interner::intern(p->typeName);
+            for(auto &def : p->defs) items.push_back(fromTree(def.get()));
+            second[n] = addList(items);
+            break;
+        }
+        case Init_Val: {
+            init_val *p = static_cast<init_val *>(root);
+            n = add(FLAT_INIT_VAL, root);
+            if(p->is_const) flags[n] |= FLAT_CONST;
+            first[n] = fromTree(p->scalar.get());
+            for(auto &child : p->children) items.push_back(fromTree(child.get()));
+            second[n] = addList(items);
+            break;
+        }
+        case Class_Def: {
+            class_def *p = static_cast<class_def *>(root);
+            n = add(FLAT_CLASS_DEF, root);
+            setType(n, p->type);
+            first[n] = p->sym;
+            for(auto &child : p->children) items.push_back(fromTree(child.get()));
+            second[n] = addList(items);
+            break;
+        }
+        case Member_Access: {
+            member_access *p = static_cast<member_access *>(root);
+            n = add(FLAT_MEMBER_ACCESS, root);
+            if(p->isFunc) flags[n] |= FLAT_METHOD;
+            first[n] = Interner::intern(p->name);
+            second[n] = fromTree(p->exp.get());
+            for(auto &arg : p->args) items.push_back(fromTree(arg.get()));
+            third[n] = addList(items);
+            break;
+        }
+        case Pointer_Acc: {
+            pointer_acc *p = static_cast<pointer_acc *>(root);
+            n = add(FLAT_POINTER_ACC, root);
+            if(p->isFunc) flags[n] |= FLAT_METHOD;
+            first[n] = Interner::intern(p->name);
+            second[n] = fromTree(p->exp.get());
+            for(auto &arg : p->args) items.push_back(fromTree(arg.get()));
+            third[n] = addList(items);
+            break;
+        }
+        case Type_Cast: {
+            type_cast *p = static_cast<type_cast *>(root);
+            n = add(FLAT_TYPE_CAST, root);
+            if(p->isImplicit) flags[n] |= FLAT_IMPLICIT;
+            second[n] = typeIndex(p->target);
+            first[n] = fromTree(p->exp.get());
+            break;
+        }
+        default:
+            std::cout << "Cannot flatten " << root->to_string() << "\n";
+            exit(1);
+    }
+    return n;
+}
+
+void flatAST::copyCommon(astHandle n, node *to) const {
+    auto error = errors.find(n);
+    if(error != errors.end()) to->error_msg = error->second;
+    if(expr *e = dynamic_cast<expr *>(to)) {
+        e->inferred_type = type(n);
+        e->is_const = (flags[n] & FLAT_CONST) != 0;
+    }
+}
+
+void flatAST::copyFolded(astHandle n, expr *to) const {
+    if(flags[n] & FLAT_FOLDED) {
+        to->const_evaluated = true;
+        to->constant = constInfo{
+            .is_const = true,
+            .value = intConstant(int32_t(third[n])),
+            .type = TypeFactory::getInt()
+        };
+    }
+}
+
+nodePtr flatAST::toTree(astHandle n) const {
+    if(n == noNode) return nullptr;
+    std::pair<size_t, size_t> loc = location(n);
+    node *res = nullptr;
+    switch(kinds[n]) {
+        case FLAT_PROGRAM: {
+            program *p = new program(loc);
+            for(astHandle child : list(first[n])) p->children.push_back(toTree(child).release());
+            res = p;
+            break;
+        }
+        case FLAT_INT_LITERAL:
+            res = new int_literal(loc, int(first[n]));
+            break;
+        case FLAT_UNARY:
+            res = new unary_expr(loc, ops[n], asExpr(toTree(first[n])));
+            copyFolded(n, static_cast<expr *>(res));
+            break;
+        case FLAT_BINARY:
+            res = new binary_expr(loc, ops[n], asExpr(toTree(first[n])), asExpr(toTree(second[n])));
+            copyFolded(n, static_cast<expr *>(res));
+            break;
+        case FLAT_SUBSCRIPT: {
+            subscript_expr *p = new subscript_expr(loc, asExpr(toTree(first[n])), asExpr(toTree(second[n])));
+            p->base_type = typeTable[third[n]];
+            res = p;
+            break;
+        }
+        case FLAT_IDENTIFIER:
+            res = new identifier(loc, std::string(name(n)), first[n]);
+            break;
+        case FLAT_EXPR_STMT:
+            res = new expr_stmt(loc, asExpr(toTree(first[n])));
+            break;
+        case FLAT_IF_ELSE:
+            res = new if_else_stmt(loc, asExpr(toTree(first[n])), asStmt(toTree(second[n])), asStmt(toTree(third[n])));
+            break;
+        case FLAT_WHILE:
+            res = new while_stmt(loc, asExpr(toTree(first[n])), asStmt(toTree(second[n])));
+            break;
+        case FLAT_BREAK:
+            res = new break_stmt(loc);
+            break;
+        case FLAT_CONTINUE:
+            res = new continue_stmt(loc);
+            break;
+        case FLAT_RETURN:
+            res = new return_stmt(loc, asExpr(toTree(first[n])));
+            break;
+        case FLAT_BLOCK: {
+            block_stmt *p = new block_stmt(loc);
+            for(astHandle item : list(first[n])) p->items.push_back(toTree(item));
+            res = p;
+            break;
+        }
+        case FLAT_FUN_CALL: {
+            fun_call *p = new fun_call(loc);
+            p->setName(std::string(name(n)), first[n]);
+            for(astHandle arg : list(second[n])) p->args.push_back(asExpr(toTree(arg)));
+            res = p;
+            break;
+        }
+        case FLAT_FUNC_DEF: {
+            func_def *p = new func_def(loc);
+            p->type = static_cast<FuncType *>(type(n));
+            p->name = name(n);
+            p->sym = first[n];
+            p->is_constructor = (flags[n] & FLAT_CTOR) != 0;
+            for(astHandle item : list(second[n])) p->body.push_back(toTree(item));
+            res = p;
+            break;
+        }
+        case FLAT_VAR_DEF: {
+            var_def *p = new var_def(loc);
+            p->setId(std::string(name(n)), first[n]);
+            p->type = type(n);
+            p->is_const = (flags[n] & FLAT_CONST) != 0;
+            p->init_val = toTree(second[n]);
+            res = p;
+            break;
+        }
+        case FLAT_VAR_DECL: {
+            var_decl *p = new var_decl(loc);
+            // the definitions are already finalized, so setTypeAndReverse is not called
+            p->typeName = name(n);
+            p->is_const = (flags[n] & FLAT_CONST) != 0;
+            for(astHandle def : list(second[n])) {
+                p->defs.push_back(vardefPtr(static_cast<var_def *>(toTree(def).release())));
+            }
+            res = p;
+            break;
+        }
+        case FLAT_INIT_VAL: {
+            init_val *p = new init_val(loc);
+            p->is_const = (flags[n] & FLAT_CONST) != 0;
+            p->scalar = asExpr(toTree(first[n]));
+            for(astHandle child : list(second[n])) {
+                p->children.push_back(initValPtr(static_cast<init_val *>(toTree(child).release())));
+            }
+            res = p;
+            break;
+        }
+        case FLAT_CLASS_DEF: {
+            class_def *p = new class_def(loc);
+            p->setName(std::string(name(n)), first[n]);
+            p->type = static_cast<ClassType *>(type(n));
+            for(astHandle child : list(second[n])) p->children.push_back(toTree(child));
+            res = p;
+            break;
+        }
+        case FLAT_MEMBER_ACCESS: {
+            member_access *p = new member_access(loc, asExpr(toTree(second[n])), std::string(name(n)));
+            p->isFunc = (flags[n] & FLAT_METHOD) != 0;
+            for(astHandle arg : list(third[n])) p->args.push_back(asExpr(toTree(arg)));
+            res = p;
+            break;
+        }
+        case FLAT_POINTER_ACC: {
+            pointer_acc *p = new pointer_acc(loc, asExpr(toTree(second[n])), std::string(name(n)));
+            p->isFunc = (flags[n] & FLAT_METHOD) != 0;
+            for(astHandle arg : list(third[n])) p->args.push_back(asExpr(toTree(arg)));
+            res = p;
+            break;
+        }
+        case FLAT_TYPE_CAST: {
+            type_cast *p = new type_cast(loc, asExpr(toTree(first[n])), typeTable[second[n]]);
+            p->isImplicit = (flags[n] & FLAT_IMPLICIT) != 0;
+            res = p;
+            break;
+        }
+    }
+    copyCommon(n, res);
+    return nodePtr(res);
+}
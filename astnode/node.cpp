@@ -6,6 +6,15 @@
 node::node(std::pair<size_t, size_t> pair) : location(pair) {}
 
 
+static const std::string opSpellings[Op_Count] = {
+    "+", "-", "*", "/", "%", "==", "!=", "<", ">", "<=", ">=", "&&", "||", "!",
+    "&", "|", "^", "<<", ">>", "=", "+=", "-=", "*=", "/=", "%=", "++", "--"
+};
+
+const std::string &opSpelling(OpKind op) {
+    return opSpellings[op];
+}
+
 std::string locToString(std::pair<size_t, size_t> location, std::string tail) {
     return " <" + std::to_string(location.first) + ":" + std::to_string(location.second) + "> " + tail + "\n";
 }
@@ -20,27 +29,17 @@ std::string program::to_string() {
     return "Program";
 }
 
-void program::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void program::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     for(size_t i = 0; i < children.size(); i++) {
         if(i != children.size() - 1) {
-            children[i]->printAST(prefix + "│   ", prefix + "├── ");
+            children[i]->printAST(prefix + "│   ", prefix + "├── ", out);
         } else {
-            children[i]->printAST(prefix + "    ", prefix + "└── ");
+            children[i]->printAST(prefix + "    ", prefix + "└── ", out);
         }
     }
 }
 
-analyzeInfo program::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo program::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-} 
-
 // Expression Nodes
 expr::expr(std::pair<size_t, size_t> loc, struct Type *ptr) : node(loc), inferred_type(ptr) {}
 
@@ -50,28 +49,18 @@ void expr::setConst(bool is_const) {
 }
 
 // Unary Expression
-unary_expr::unary_expr(std::pair<size_t, size_t> loc, std::string op, expPtr operand)
+unary_expr::unary_expr(std::pair<size_t, size_t> loc, OpKind op, expPtr operand)
     : expr(loc, nullptr), op(op), operand(std::move(operand)) {
         kind = ASTKind::Unary_Op;
     }
 
 std::string unary_expr::to_string() {
-    return "unary_expr <op " + op + "> " + (inferred_type ? color::magenta + std::string("inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
+    return "unary_expr <op " + opSpelling(op) + "> " + (inferred_type ? color::magenta + std::string("inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
 }
 
-void unary_expr::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    operand->printAST(prefix + "    ", prefix + "└── ");
-}
-
-analyzeInfo unary_expr::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo unary_expr::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+void unary_expr::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    operand->printAST(prefix + "    ", prefix + "└── ", out);
 }
 
 constInfo unary_expr::const_eval(TypeChecker *ptr)
@@ -81,29 +70,19 @@ constInfo unary_expr::const_eval(TypeChecker *ptr)
 
 
 // Binary Expression
-binary_expr::binary_expr(std::pair<size_t, size_t> loc, std::string op, expPtr left, expPtr right)
+binary_expr::binary_expr(std::pair<size_t, size_t> loc, OpKind op, expPtr left, expPtr right)
     : expr(loc, nullptr), op(op), left(std::move(left)), right(std::move(right)) {
         kind = ASTKind::Binary_Op;
     }
 
 std::string binary_expr::to_string() {
-    return "binary_expr <op " + op + "> " + (inferred_type ? color::magenta + std::string("inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
-}
-
-void binary_expr::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    left->printAST(prefix + "│   ", prefix + "├── ");
-    right->printAST(prefix + "    ", prefix + "└── ");
-}
-
-analyzeInfo binary_expr::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
+    return "binary_expr <op " + opSpelling(op) + "> " + (inferred_type ? color::magenta + std::string("inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
 }
 
-codeGenInfo binary_expr::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+void binary_expr::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    left->printAST(prefix + "│   ", prefix + "├── ", out);
+    right->printAST(prefix + "    ", prefix + "└── ", out);
 }
 
 constInfo binary_expr::const_eval(TypeChecker *ptr)
@@ -165,118 +144,78 @@ stmt::stmt(std::pair<size_t, size_t> loc) : node(loc) {}
 
 // Expression Statement
 expr_stmt::expr_stmt(std::pair<size_t, size_t> loc, expPtr ptr)
-    : stmt(loc), ptr(std::move(ptr)) {}
+    : stmt(loc), ptr(std::move(ptr)) {
+        kind = ASTKind::Expr_Stmt;
+    }
 
 std::string expr_stmt::to_string() {
     return "expr_stmt";
 }
 
-void expr_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    ptr->printAST(prefix + "    ", prefix + "└── ");
-}
-
-analyzeInfo expr_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo expr_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+void expr_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    ptr->printAST(prefix + "    ", prefix + "└── ", out);
 }
 
 // If-Else Statement
 if_else_stmt::if_else_stmt(std::pair<size_t, size_t> loc, expPtr cond, stmtPtr if_branch, stmtPtr else_branch)
-    : stmt(loc), cond(std::move(cond)), if_branch(std::move(if_branch)), else_branch(std::move(else_branch)) {}
+    : stmt(loc), cond(std::move(cond)), if_branch(std::move(if_branch)), else_branch(std::move(else_branch)) {
+        kind = ASTKind::IF_ELSE_Stmt;
+    }
 
 std::string if_else_stmt::to_string() {
     return else_branch ? "if_else_stmt" : "if_stmt";
 }
 
-void if_else_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    cond->printAST(prefix + "    ", prefix + "├──(cond) ");
+void if_else_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    cond->printAST(prefix + "    ", prefix + "├──(cond) ", out);
     if_branch->printAST(prefix + (else_branch ? "│   " : "    "), 
-                       prefix + (else_branch ? "├──(if) " : "└──(if) "));
+                       prefix + (else_branch ? "├──(if) " : "└──(if) "), out);
     if (else_branch) {
-        else_branch->printAST(prefix + "    ", prefix + "└──(else) ");
+        else_branch->printAST(prefix + "    ", prefix + "└──(else) ", out);
     }
 }
 
-analyzeInfo if_else_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo if_else_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 while_stmt::while_stmt(std::pair<size_t, size_t> loc, expPtr cond, stmtPtr body)
-    : stmt(loc), cond(std::move(cond)), body(std::move(body)) {}
+    : stmt(loc), cond(std::move(cond)), body(std::move(body)) {
+        kind = ASTKind::WHILE_Stmt;
+    }
 
 std::string while_stmt::to_string() {
     return "while_stmt";
 }
 
-void while_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    cond->printAST(prefix + "    ", prefix + "├──(cond) ");
-    body->printAST(prefix + "    ", prefix + "└──(body) ");
-}
-
-analyzeInfo while_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo while_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+void while_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    cond->printAST(prefix + "    ", prefix + "├──(cond) ", out);
+    body->printAST(prefix + "    ", prefix + "└──(body) ", out);
 }
 
 // Break Statement
-break_stmt::break_stmt(std::pair<size_t, size_t> loc) : stmt(loc) {}
+break_stmt::break_stmt(std::pair<size_t, size_t> loc) : stmt(loc) {
+    kind = ASTKind::Break_Stmt;
+}
 
 std::string break_stmt::to_string() {
     return "break_stmt";
 }
 
-void break_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-}
-
-analyzeInfo break_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo break_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+void break_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
 }
 
 // Continue Statement
-continue_stmt::continue_stmt(std::pair<size_t, size_t> loc) : stmt(loc) {}
+continue_stmt::continue_stmt(std::pair<size_t, size_t> loc) : stmt(loc) {
+    kind = ASTKind::Continue_Stmt;
+}
 
 std::string continue_stmt::to_string() {
     return "continue_stmt";
 }
 
-void continue_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-}
-
-analyzeInfo continue_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo continue_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+void continue_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
 }
 
 // Return Statement
@@ -289,25 +228,17 @@ std::string return_stmt::to_string() {
     return "return_stmt ";
 }
 
-void return_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void return_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     if (value) {
-        value->printAST(prefix + "    ", prefix + "└──(value) ");
+        value->printAST(prefix + "    ", prefix + "└──(value) ", out);
     }
 }
 
-analyzeInfo return_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo return_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 // Block Statement
-block_stmt::block_stmt(std::pair<size_t, size_t> loc) : stmt(loc) {}
+block_stmt::block_stmt(std::pair<size_t, size_t> loc) : stmt(loc) {
+    kind = ASTKind::Block_Stmt;
+}
 
 void block_stmt::add_item(nodePtr item) {
     if (item) items.push_back(std::move(item));
@@ -321,39 +252,30 @@ std::string block_stmt::to_string() {
     return "block_stmt";
 }
 
-void block_stmt::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void block_stmt::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     for (size_t i = 0; i < items.size(); ++i) {
         if (i != items.size() - 1) {
-            items[i]->printAST(prefix + "│   ", prefix + "├── ");
+            items[i]->printAST(prefix + "│   ", prefix + "├── ", out);
         } else {
-            items[i]->printAST(prefix + "    ", prefix + "└── ");
+            items[i]->printAST(prefix + "    ", prefix + "└── ", out);
         }
     }
 }
 
-analyzeInfo block_stmt::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo block_stmt::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 // ==================== Expression Nodes ====================
 
 // Literal Base Class
 literal::literal(std::pair<size_t, size_t> loc) : expr(loc, nullptr) {}
 
-void literal::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void literal::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
 }
 
 // Integer Literal
 int_literal::int_literal(std::pair<size_t, size_t> loc, int val)
     : literal(loc) {
+        kind = ASTKind::Int_Literal;
         value = val;
     }
 
@@ -361,30 +283,23 @@ std::string int_literal::to_string() {
     return "int_literal <value " + std::to_string(value) + "> " + (inferred_type ? color::magenta + std::string("inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
 }
 
-analyzeInfo int_literal::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo int_literal::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 constInfo int_literal::const_eval(TypeChecker *ptr)
 {
     return ptr->const_eval(this);
 }
 
 fun_call::fun_call(std::pair<size_t, size_t> loc)
-    : expr(loc, nullptr) {}
+    : expr(loc, nullptr) {
+        kind = ASTKind::Fun_Call;
+    }
 
 void fun_call::addParam(expPtr param) {
     args.push_back(std::move(param));
 }
 
-void fun_call::setName(std::string name) {
+void fun_call::setName(std::string name, symId sym) {
     this->func_name = name;
+    this->func_sym = sym;
 }
 
 std::string fun_call::to_string() {
@@ -401,27 +316,17 @@ void fun_call::setLoc(std::pair<size_t, size_t> loc) {
     location = loc;
 }
 
-void fun_call::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void fun_call::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     for (size_t i = 0; i < args.size(); ++i) {
         if (i != args.size() - 1) {
-            args[i]->printAST(prefix + "│    ", prefix + "├── (arg" + std::to_string(i) + ") ");
+            args[i]->printAST(prefix + "│    ", prefix + "├── (arg" + std::to_string(i) + ") ", out);
         } else {
-            args[i]->printAST(prefix + "     ", prefix + "└── (arg" + std::to_string(i) + ") ");
+            args[i]->printAST(prefix + "     ", prefix + "└── (arg" + std::to_string(i) + ") ", out);
         }
     }
 }
 
-analyzeInfo fun_call::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo fun_call::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 constInfo fun_call::const_eval(TypeChecker *ptr)
 {
     return ptr->const_eval(this);
@@ -451,58 +356,49 @@ std::string func_def::to_string() {
     return {};
 }
 
-void func_def::printArgList(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << "paramList\n";
+void func_def::printArgList(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << "paramList\n";
     for (size_t i = 0; i < type->argTypeList.size()  ; ++i) {
         if(i != type->argTypeList.size() - 1) {
-            std::cout   << prefix + "├── (arg" + std::to_string(i) + " "
-                        << type->bindings[i] 
-                        << " "
-                        << type->argTypeList[i]->to_string() + "\n";
+            out << prefix + "├── (arg" + std::to_string(i) + " "
+                << Interner::spelling(type->bindings[i]) 
+                << " "
+                << type->argTypeList[i]->to_string() + "\n";
         } else {
-            std::cout   << prefix + "└── (arg" + std::to_string(i) + " " 
-                        << type->bindings[i]
-                        << " "
-                        << type->argTypeList[i]->to_string() + "\n";
+            out << prefix + "└── (arg" + std::to_string(i) + " " 
+                << Interner::spelling(type->bindings[i])
+                << " "
+                << type->argTypeList[i]->to_string() + "\n";
         }
     }
 }
 
-void func_def::printAST(std::string prefix, std::string info_prefix) {
+void func_def::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
     if(type == nullptr) return;
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    printArgList(prefix + "│   ", prefix + "├── ");
-    std::cout << prefix + "└── " + "block\n";
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    printArgList(prefix + "│   ", prefix + "├── ", out);
+    out << prefix + "└── " + "block\n";
     for (size_t i = 0; i < body.size(); ++i) {
         if(i != body.size() - 1) {
-            body[i]->printAST(prefix + "    │   ", prefix + "    ├── ");
+            body[i]->printAST(prefix + "    │   ", prefix + "    ├── ", out);
         } else {
-            body[i]->printAST(prefix + "        ", prefix + "    └── ");
+            body[i]->printAST(prefix + "        ", prefix + "    └── ", out);
         }
     }
 }
 
-analyzeInfo func_def::dispatch(TypeChecker *ptr)
-{
-    auto info = ptr->analyze(this); 
-    ptr->analyzeFunctionBody(this);
-    return info;
-}
-
-codeGenInfo func_def::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 void func_def::setCtor() {
     is_constructor = true;
 }
 
 // Variable Definition
-var_def::var_def(std::pair<size_t, size_t> loc) : node(loc) {}
+var_def::var_def(std::pair<size_t, size_t> loc) : node(loc) {
+    kind = ASTKind::Var_Def;
+}
 
-void var_def::setId(const std::string& name) {
+void var_def::setId(const std::string& name, symId sym) {
     id = name;
+    this->sym = sym;
 }
 
 
@@ -522,33 +418,21 @@ std::string var_def::to_string() {
     return res;
 }
 
-void var_def::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << "\n";
+void var_def::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << "\n";
     if(type && type->kind == TypeKind::Array) {
         ArrayType *p = static_cast<ArrayType*>(type);
         if(!init_val) {
-            p->printUnevaludatedType(prefix + "    ", prefix + "└── ");
+            p->printUnevaludatedType(prefix + "    ", prefix + "└── ", out);
         } else {
-            p->printUnevaludatedType(prefix + "│   ", prefix + "├── ");
+            p->printUnevaludatedType(prefix + "│   ", prefix + "├── ", out);
         }
     }
     if(init_val) {
-        init_val->printAST(prefix + "    ", prefix + "└── ");
+        init_val->printAST(prefix + "    ", prefix + "└── ", out);
     }
 }
 
-analyzeInfo var_def::dispatch(TypeChecker *ptr)
-{
-    auto info = ptr->analyze(this);
-    ptr->analyzeInit(this);
-    return info;
-}
-
-codeGenInfo var_def::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 // Variable Declaration
 var_decl::var_decl(std::pair<size_t, size_t> loc) : node(loc) {
     kind = ASTKind::Var_Decl;
@@ -575,27 +459,17 @@ std::string var_decl::to_string() {
     return "VarDecl <type: " + std::string(is_const ? "const " : "") + typeName + ">";
 }
 
-void var_decl::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void var_decl::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     for (size_t i = 0; i < defs.size(); ++i) {
         if (i != defs.size() - 1) {
-            defs[i]->printAST(prefix + "│   ", prefix + "├── ");
+            defs[i]->printAST(prefix + "│   ", prefix + "├── ", out);
         } else {
-            defs[i]->printAST(prefix + "    ", prefix + "└── ");
+            defs[i]->printAST(prefix + "    ", prefix + "└── ", out);
         }
     }
 }
 
-analyzeInfo var_decl::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo var_decl::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 void var_def::finalizeType(std::string type_name) {
     if(this->type == nullptr) {
         this->type = TypeFactory::getTypeFromName(type_name);
@@ -633,7 +507,9 @@ void var_decl::finalize() {
 }
 
 // Initial Value
-init_val::init_val(std::pair<size_t, size_t> loc) : node(loc) {}
+init_val::init_val(std::pair<size_t, size_t> loc) : node(loc) {
+    kind = ASTKind::Init_Val;
+}
 
 void init_val::addChild(initValPtr child) {
     children.push_back(std::move(child));
@@ -663,31 +539,21 @@ std::string init_val::to_string() {
     return (is_const ? "ConstInitVal" : "InitVal");
 }
 
-void init_val::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void init_val::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     if(scalar) {
-        scalar->printAST(prefix + "    ", prefix + "└── ");
+        scalar->printAST(prefix + "    ", prefix + "└── ", out);
     } else {
         for (size_t i = 0; i < children.size(); ++i) {
             if (i != children.size() - 1) {
-                children[i]->printAST(prefix + "│   ", prefix + "├── ");
+                children[i]->printAST(prefix + "│   ", prefix + "├── ", out);
             } else {
-                children[i]->printAST(prefix + "    ", prefix + "└── ");
+                children[i]->printAST(prefix + "    ", prefix + "└── ", out);
             }
         }
     }
 }
 
-analyzeInfo init_val::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo init_val::dispatch(codeGen *ptr)
-{
-    return codeGenInfo();
-}
-
 class_def::class_def(std::pair<size_t, size_t> loc)
 : node(loc) {
     kind = ASTKind::Class_Def;
@@ -697,8 +563,9 @@ void class_def::addChild(nodePtr child) {
     children.push_back(std::move(child));
 }
 
-void class_def::setName(std::string name) {
+void class_def::setName(std::string name, symId sym) {
     this->name = name;
+    this->sym = sym;
 }
 
 void class_def::setLoc(std::pair<size_t, size_t> loc) {
@@ -713,28 +580,20 @@ void class_def::reverseChildren() {
     std::reverse(children.begin(), children.end());
 }
 
-void class_def::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void class_def::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     for (size_t i = 0; i < children.size(); ++i) {
         if (i != children.size() - 1) {
-            children[i]->printAST(prefix + "│   ", prefix + "├── ");
+            children[i]->printAST(prefix + "│   ", prefix + "├── ", out);
         } else {
-            children[i]->printAST(prefix + "    ", prefix + "└── ");
+            children[i]->printAST(prefix + "    ", prefix + "└── ", out);
         }
     }
 }
 
-analyzeInfo class_def::dispatch(TypeChecker *ptr) {
-    return ptr->analyze(this);
-}
-
-codeGenInfo class_def::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 member_access::member_access(std::pair<size_t, size_t> loc, expPtr exp, const std::string &name)
 : expr(loc, nullptr) {
+    kind = ASTKind::Member_Access;
     this->exp = std::move(exp);
     this->name = name;
 }
@@ -743,41 +602,33 @@ std::string member_access::to_string() {
     return "member_access <kind " + std::string(isFunc ? "method" : "var") + ", member " + name + ">";
 }
 
-void member_access::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void member_access::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     if(!isFunc) {
-        exp->printAST(prefix + "     ", prefix + "└── objexpr: ");
+        exp->printAST(prefix + "     ", prefix + "└── objexpr: ", out);
     } else {
-        exp->printAST(prefix + "│    ", prefix + "├── objexpr: ");
+        exp->printAST(prefix + "│    ", prefix + "├── objexpr: ", out);
         for(size_t i = 0; i < args.size(); i++) {
             if (i != args.size() - 1) {
-                args[i]->printAST(prefix + "│    ", prefix + "├── arg " + std::to_string(i) + ") ");
+                args[i]->printAST(prefix + "│    ", prefix + "├── arg " + std::to_string(i) + ") ", out);
             } else {
-                args[i]->printAST(prefix + "     ", prefix + "└── arg " + std::to_string(i) + ") ");
+                args[i]->printAST(prefix + "     ", prefix + "└── arg " + std::to_string(i) + ") ", out);
             }
         }
     }
 }
 
-analyzeInfo member_access::dispatch(TypeChecker *ptr) {
-    return ptr->analyze(this);
-}
-
-codeGenInfo member_access::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 constInfo member_access::const_eval(TypeChecker *ptr) {
     return constInfo{
         .is_const = false,
-        .value = nullptr,
+        .value = {},
         .type = nullptr
     };
 }
 
 pointer_acc::pointer_acc(std::pair<size_t, size_t> loc, expPtr exp, const std::string &name) 
 : expr(loc, nullptr){
+    kind = ASTKind::Pointer_Acc;
     this->exp = std::move(exp);
     this->name = name;
 }
@@ -789,37 +640,27 @@ std::string pointer_acc::to_string() {
 }
 
 // Print AST structure
-void pointer_acc::printAST(std::string prefix, std::string info_prefix) {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
+void pointer_acc::printAST(std::string prefix, std::string info_prefix, std::ostream &out) {
+    out << info_prefix << to_string() << locToString(location, error_msg);
     if(!isFunc) {
-        exp->printAST(prefix + "     ", prefix + "└── objptr: ");
+        exp->printAST(prefix + "     ", prefix + "└── objptr: ", out);
     } else {
-        exp->printAST(prefix + "│    ", prefix + "├── objptr: ");
+        exp->printAST(prefix + "│    ", prefix + "├── objptr: ", out);
         for(size_t i = 0; i < args.size(); i++) {
             if (i != args.size() - 1) {
-                args[i]->printAST(prefix + "│    ", prefix + "├── arg " + std::to_string(i) + ") ");
+                args[i]->printAST(prefix + "│    ", prefix + "├── arg " + std::to_string(i) + ") ", out);
             } else {
-                args[i]->printAST(prefix + "     ", prefix + "└── arg " + std::to_string(i) + ") ");
+                args[i]->printAST(prefix + "     ", prefix + "└── arg " + std::to_string(i) + ") ", out);
             }
         }
     }
 }
 
-// Type checking dispatch
-analyzeInfo pointer_acc::dispatch(TypeChecker *ptr) {
-    return ptr->analyze(this);
-}
-
-codeGenInfo pointer_acc::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
-}
-
 // Constant expression evaluation (if applicable)
 constInfo pointer_acc::const_eval(TypeChecker *ptr) {
     return constInfo{
         .is_const = false,
-        .value = nullptr,
+        .value = {},
         .type = nullptr
     };
 }
@@ -827,6 +668,7 @@ constInfo pointer_acc::const_eval(TypeChecker *ptr) {
 type_cast::type_cast(std::pair<size_t, size_t> loc, expPtr exp, Type *target)
 : expr(loc, nullptr)
 {
+    kind = ASTKind::Type_Cast;
     this->exp = std::move(exp);
     this->target = target;
     isImplicit = false;
@@ -834,6 +676,7 @@ type_cast::type_cast(std::pair<size_t, size_t> loc, expPtr exp, Type *target)
 
 type_cast::type_cast(expPtr exp, Type *target)
 : expr({0,0}, nullptr){
+    kind = ASTKind::Type_Cast;
     this->exp = std::move(exp);
     this->target = target;
     isImplicit = true;
@@ -845,20 +688,10 @@ std::string type_cast::to_string()
     (inferred_type ? color::magenta + std::string(" inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
 }
 
-void type_cast::printAST(std::string prefix, std::string info_prefix)
-{
-    std::cout << info_prefix << to_string() << (!isImplicit ? locToString(location, error_msg) : " " + error_msg + "\n");
-    exp->printAST(prefix + "    ", prefix + "└── ");
-}
-
-analyzeInfo type_cast::dispatch(TypeChecker *ptr)
+void type_cast::printAST(std::string prefix, std::string info_prefix, std::ostream &out)
 {
-    return analyzeInfo();
-}
-
-codeGenInfo type_cast::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+    out << info_prefix << to_string() << (!isImplicit ? locToString(location, error_msg) : " " + error_msg + "\n");
+    exp->printAST(prefix + "    ", prefix + "└── ", out);
 }
 
 constInfo type_cast::const_eval(TypeChecker *ptr)
@@ -868,6 +701,7 @@ constInfo type_cast::const_eval(TypeChecker *ptr)
 
 subscript_expr::subscript_expr(std::pair<size_t, size_t> loc, expPtr list, expPtr sub)
 :expr(loc, nullptr) {
+    kind = ASTKind::Subscript_Expr;
     this->list = std::move(list);
     this->sub = std::move(sub);
 }
@@ -878,21 +712,11 @@ std::string subscript_expr::to_string()
         (inferred_type ? color::magenta + std::string(" inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
 }
 
-void subscript_expr::printAST(std::string prefix, std::string info_prefix)
-{
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-    list->printAST(prefix + "│   ", prefix + "├── ");
-    sub->printAST(prefix + "    ", prefix + "└── ");
-}
-
-analyzeInfo subscript_expr::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo subscript_expr::dispatch(codeGen *ptr)
+void subscript_expr::printAST(std::string prefix, std::string info_prefix, std::ostream &out)
 {
-    return ptr->analyze(this);
+    out << info_prefix << to_string() << locToString(location, error_msg);
+    list->printAST(prefix + "│   ", prefix + "├── ", out);
+    sub->printAST(prefix + "    ", prefix + "└── ", out);
 }
 
 constInfo subscript_expr::const_eval(TypeChecker *ptr)
@@ -900,8 +724,9 @@ constInfo subscript_expr::const_eval(TypeChecker *ptr)
     return constInfo();
 }
 
-identifier::identifier(std::pair<size_t, size_t> loc, std::string name)
-:expr(loc, nullptr) {
+identifier::identifier(std::pair<size_t, size_t> loc, std::string name, symId sym)
+:expr(loc, nullptr), sym(sym) {
+    kind = ASTKind::Identifier;
     this->name = name;
 }
 
@@ -911,22 +736,12 @@ std::string identifier::to_string()
         inferred_type ? color::magenta + std::string(" inferredType: ") + inferred_type->to_string() + color::reset + " ": "");
 }
 
-void identifier::printAST(std::string prefix, std::string info_prefix)
+void identifier::printAST(std::string prefix, std::string info_prefix, std::ostream &out)
 {
-    std::cout << info_prefix << to_string() << locToString(location, error_msg);
-}
-
-analyzeInfo identifier::dispatch(TypeChecker *ptr)
-{
-    return ptr->analyze(this);
-}
-
-codeGenInfo identifier::dispatch(codeGen *ptr)
-{
-    return ptr->analyze(this);
+    out << info_prefix << to_string() << locToString(location, error_msg);
 }
 
 constInfo identifier::const_eval(TypeChecker *ptr)
 {
-    return constInfo();
+    return ptr->const_eval(this);
 }
@@ -0,0 +1,115 @@
+/*
+    AST cache benchmark.
+
+    usage: astCacheBench <file.sy> [rounds]
+
+    Compiles the input to LLVM IR twice in a fresh cache directory: once after a miss,
+    through tokenize, Parse and the TypeChecker, storing the checked AST, and once from
+    the cache entry.
+    The IR of both must be the same before anything is reported. Reports the time of the
+    front end (Parse and the TypeChecker, without codegen) against that of a cache load,
+    the size of the entry and the statistics of the cache.
+*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include "parser/parser.hpp"
+#include "parser/astnodes/astCache.hpp"
+#include "benchUtil.hpp"
+
+// The checked program, or nullptr if it does not parse or has type errors.
+nodePtr frontEnd(const sourceFile &file) {
+    tokenSource source(file);
+    parseResult result = Parse(source, builtinLRTable());
+    if(result.node == nullptr) return nullptr;
+    TypeChecker checker;
+    checker.setSource(file);
+    checker.analyze(static_cast<program *>(result.node->ptr.get()));
+    if(checker.hasTypeError()) return nullptr;
+    return std::move(result.node->ptr);
+}
+
+std::string generateIR(node *root, const std::string &path) {
+    // codeGen also prints parts of the module to llvm::outs()
+    int console = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    {
+        codeGen gen;
+        gen.setOutputFileName(path);
+        gen.setViewCFG(false);
+        gen.analyze(static_cast<program *>(root));
+    }
+    llvm::outs().flush();
+    dup2(console, STDOUT_FILENO);
+    close(console);
+    close(null);
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cout << "usage: " << argv[0] << " <file.sy> [rounds]\n";
+        return 1;
+    }
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 20;
+
+    SourceManager sources;
+    const sourceFile &file = sources.load(argv[1]);
+    std::string dir = (std::filesystem::temp_directory_path() / ("astCacheBench" + std::to_string(getpid()))).string();
+    astCache cache(dir);
+
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+    std::string cold, cached;
+    {
+        astArena arena;
+        astArena::scope useArena(arena);
+        // the lookup of a first compilation, which misses
+        nodePtr checked = cache.load(file.text);
+        if(checked == nullptr) checked = frontEnd(file);
+        if(checked != nullptr) {
+            cold = generateIR(checked.get(), dir + "/cold.ll");
+            cache.store(file.text, checked.get());
+        }
+    }
+    {
+        astArena arena;
+        astArena::scope useArena(arena);
+        nodePtr loaded = cache.load(file.text);
+        if(loaded != nullptr) cached = generateIR(loaded.get(), dir + "/cached.ll");
+    }
+    std::cout.rdbuf(console);
+    if(cold.empty()) {
+        std::cout << "the input does not compile, not timing\n";
+        return 1;
+    }
+    if(cold != cached) {
+        std::cout << "the cached AST does not give the same IR, not timing\n";
+        return 1;
+    }
+
+    console = std::cout.rdbuf(&null);
+    double frontTime = bestSeconds(rounds, [&] {
+        astArena arena;
+        astArena::scope useArena(arena);
+        frontEnd(file);
+    });
+    double loadTime = bestSeconds(rounds, [&] {
+        astArena arena;
+        astArena::scope useArena(arena);
+        cache.load(file.text);
+    });
+    std::cout.rdbuf(console);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "input:      " << argv[1] << ", " << file.text.size() << " bytes\n"
+              << "entry:      " << std::filesystem::file_size(cache.entryPath(file.text)) << " bytes\n"
+              << "front end:  " << std::setw(9) << frontTime * 1e3 << " ms\n"
+              << "cache load: " << std::setw(9) << loadTime * 1e3 << " ms (" << std::setprecision(1)
+              << frontTime / loadTime << "x faster)\n";
+    cache.printStats(std::cout);
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef __BENCH_UTIL_H
+#define __BENCH_UTIL_H
+
+#include <algorithm>
+#include <chrono>
+#include <streambuf>
+
+// A buffer that drops what is written to it, for putting in place of that of std::cout
+// while the traces of the lexer, parser and checker would swamp the report. Formatting the
+// output is still paid for.
+struct nullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+};
+
+// The fastest of `rounds` runs of fn, in seconds.
+template <typename Fn>
+double bestSeconds(size_t rounds, Fn fn) {
+    double best = 1e30;
+    for(size_t r = 0; r < rounds; r++) {
+        auto begin = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+#endif
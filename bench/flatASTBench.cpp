@@ -0,0 +1,199 @@
+/*
+    Flat AST benchmark.
+
+    usage: flatASTBench <file.sy> [copies] [rounds]
+
+    Parses the input, concatenated `copies` times, and converts the AST to a flatAST.
+    Reports the bytes of the node tree (its astArena) against those of the flat columns,
+    and the time of a pass that counts the nodes and sums the integer literals over each:
+    a recursive walk of the tree, a recursive walk of the flat handles, and a scan of the
+    flat columns, which the preorder layout allows. The tree rebuilt by toTree must print
+    the same as the parsed one before anything is reported.
+*/
+#include "parser/parser.hpp"
+#include "parser/astnodes/flatAST.hpp"
+#include "benchUtil.hpp"
+
+struct walkResult {
+    size_t nodes = 0;
+    int64_t literals = 0;
+};
+
+// The tree has no generic child access, so the walk finds the class of each node.
+void walkTree(node *n, walkResult &res) {
+    if(n == nullptr) return;
+    res.nodes++;
+    if(program *p = dynamic_cast<program *>(n)) {
+        for(node *child : p->children) walkTree(child, res);
+    } else if(int_literal *p = dynamic_cast<int_literal *>(n)) {
+        res.literals += p->value;
+    } else if(unary_expr *p = dynamic_cast<unary_expr *>(n)) {
+        walkTree(p->operand.get(), res);
+    } else if(binary_expr *p = dynamic_cast<binary_expr *>(n)) {
+        walkTree(p->left.get(), res);
+        walkTree(p->right.get(), res);
+    } else if(subscript_expr *p = dynamic_cast<subscript_expr *>(n)) {
+        walkTree(p->list.get(), res);
+        walkTree(p->sub.get(), res);
+    } else if(expr_stmt *p = dynamic_cast<expr_stmt *>(n)) {
+        walkTree(p->ptr.get(), res);
+    } else if(if_else_stmt *p = dynamic_cast<if_else_stmt *>(n)) {
+        walkTree(p->cond.get(), res);
+        walkTree(p->if_branch.get(), res);
+        walkTree(p->else_branch.get(), res);
+    } else if(while_stmt *p = dynamic_cast<while_stmt *>(n)) {
+        walkTree(p->cond.get(), res);
+        walkTree(p->body.get(), res);
+    } else if(return_stmt *p = dynamic_cast<return_stmt *>(n)) {
+        walkTree(p->value.get(), res);
+    } else if(block_stmt *p = dynamic_cast<block_stmt *>(n)) {
+        for(auto &item : p->items) walkTree(item.get(), res);
+    } else if(fun_call *p = dynamic_cast<fun_call *>(n)) {
+        for(auto &arg : p->args) walkTree(arg.get(), res);
+    } else if(func_def *p = dynamic_cast<func_def *>(n)) {
+        for(auto &item : p->body) walkTree(item.get(), res);
+    } else if(var_def *p = dynamic_cast<var_def *>(n)) {
+        walkTree(p->init_val.get(), res);
+    } else if(var_decl *p = dynamic_cast<var_decl *>(n)) {
+        for(auto &def : p->defs) walkTree(def.get(), res);
+    } else if(init_val *p = dynamic_cast<init_val *>(n)) {
+        walkTree(p->scalar.get(), res);
+        for(auto &child : p->children) walkTree(child.get(), res);
+    } else if(class_def *p = dynamic_cast<class_def *>(n)) {
+        for(auto &child : p->children) walkTree(child.get(), res);
+    } else if(member_access *p = dynamic_cast<member_access *>(n)) {
+        walkTree(p->exp.get(), res);
+        for(auto &arg : p->args) walkTree(arg.get(), res);
+    } else if(pointer_acc *p = dynamic_cast<pointer_acc *>(n)) {
+        walkTree(p->exp.get(), res);
+        for(auto &arg : p->args) walkTree(arg.get(), res);
+    } else if(type_cast *p = dynamic_cast<type_cast *>(n)) {
+        walkTree(p->exp.get(), res);
+    }
+}
+
+void walkFlat(const flatAST &ast, astHandle n, walkResult &res) {
+    if(n == noNode) return;
+    res.nodes++;
+    switch(ast.kinds[n]) {
+        case FLAT_INT_LITERAL:
+            res.literals += int32_t(ast.first[n]);
+            break;
+        case FLAT_UNARY: case FLAT_EXPR_STMT: case FLAT_RETURN: case FLAT_TYPE_CAST:
+            walkFlat(ast, ast.first[n], res);
+            break;
+        case FLAT_BINARY: case FLAT_SUBSCRIPT: case FLAT_WHILE:
+            walkFlat(ast, ast.first[n], res);
+            walkFlat(ast, ast.second[n], res);
+            break;
+        case FLAT_IF_ELSE:
+            walkFlat(ast, ast.first[n], res);
+            walkFlat(ast, ast.second[n], res);
+            walkFlat(ast, ast.third[n], res);
+            break;
+        case FLAT_PROGRAM: case FLAT_BLOCK:
+            for(astHandle child : ast.list(ast.first[n])) walkFlat(ast, child, res);
+            break;
+        case FLAT_FUN_CALL: case FLAT_FUNC_DEF: case FLAT_VAR_DECL: case FLAT_CLASS_DEF:
+            for(astHandle child : ast.list(ast.second[n])) walkFlat(ast, child, res);
+            break;
+        case FLAT_VAR_DEF:
+            walkFlat(ast, ast.second[n], res);
+            break;
+        case FLAT_INIT_VAL:
+            walkFlat(ast, ast.first[n], res);
+            for(astHandle child : ast.list(ast.second[n])) walkFlat(ast, child, res);
+            break;
+        case FLAT_MEMBER_ACCESS: case FLAT_POINTER_ACC:
+            walkFlat(ast, ast.second[n], res);
+            for(astHandle child : ast.list(ast.third[n])) walkFlat(ast, child, res);
+            break;
+        default:
+            break;
+    }
+}
+
+walkResult scanFlat(const flatAST &ast) {
+    walkResult res;
+    res.nodes = ast.size();
+    for(size_t n = 0; n < ast.size(); n++) {
+        if(ast.kinds[n] == FLAT_INT_LITERAL) res.literals += int32_t(ast.first[n]);
+    }
+    return res;
+}
+
+std::string printed(node *root) {
+    std::stringstream out;
+    std::streambuf *console = std::cout.rdbuf(out.rdbuf());
+    root->printAST("", "");
+    std::cout.rdbuf(console);
+    return out.str();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cout << "usage: " << argv[0] << " <file.sy> [copies] [rounds]\n";
+        return 1;
+    }
+    size_t copies = argc > 2 ? std::stoul(argv[2]) : 4096;
+    size_t rounds = argc > 3 ? std::stoul(argv[3]) : 5;
+
+    SourceManager sources;
+    std::string_view unit = sources.load(argv[1]).text;
+    std::string code;
+    code.reserve(unit.size() * copies);
+    for(size_t i = 0; i < copies; i++) {
+        code += unit;
+    }
+    sourceFile file(argv[1], code);
+
+    astArena arena;
+    astArena::scope useArena(arena);
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+    tokenSource source(file);
+    parseResult result = Parse(source, builtinLRTable());
+    std::cout.rdbuf(console);
+    if(result.node == nullptr) {
+        std::cout << "the input does not parse\n";
+        return 1;
+    }
+    node *root = result.node->ptr.get();
+    size_t treeBytes = arena.bytesUsed();
+
+    flatAST flat;
+    astHandle flatRoot = flat.fromTree(root);
+    flat.shrinkToFit();
+    {
+        astArena copyArena;
+        astArena::scope useCopyArena(copyArena);
+        nodePtr copy = flat.toTree(flatRoot);
+        if(printed(copy.get()) != printed(root)) {
+            std::cout << "toTree does not give back the parsed AST, not timing\n";
+            return 1;
+        }
+    }
+
+    walkResult tree, recursive, scan;
+    double treeTime = bestSeconds(rounds, [&] { tree = walkResult(); walkTree(root, tree); });
+    double flatTime = bestSeconds(rounds, [&] { recursive = walkResult(); walkFlat(flat, flatRoot, recursive); });
+    double scanTime = bestSeconds(rounds, [&] { scan = scanFlat(flat); });
+    if(tree.nodes != recursive.nodes || tree.nodes != scan.nodes || tree.literals != scan.literals) {
+        std::cout << "the walks disagree (" << tree.nodes << ", " << recursive.nodes << ", " << scan.nodes << " nodes)\n";
+        return 1;
+    }
+    double convertTime = bestSeconds(rounds, [&] { flatAST other; other.fromTree(root); });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:      " << argv[1] << " x" << copies << ", " << tree.nodes << " nodes\n"
+              << "tree:       " << std::setw(9) << treeBytes / 1024.0 << " KB, "
+              << double(treeBytes) / tree.nodes << " bytes/node\n"
+              << "flat:       " << std::setw(9) << flat.bytes() / 1024.0 << " KB, "
+              << double(flat.bytes()) / tree.nodes << " bytes/node (" << double(treeBytes) / flat.bytes() << "x smaller)\n"
+              << "fromTree:   " << std::setw(9) << convertTime * 1e3 << " ms\n"
+              << "tree walk:  " << std::setw(9) << treeTime * 1e3 << " ms\n"
+              << "flat walk:  " << std::setw(9) << flatTime * 1e3 << " ms (" << treeTime / flatTime << "x faster)\n"
+              << "flat scan:  " << std::setw(9) << scanTime * 1e3 << " ms (" << treeTime / scanTime << "x faster)\n"
+              << "checksum: " << tree.literals << "\n";
+    return 0;
+}
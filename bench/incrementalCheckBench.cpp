@@ -0,0 +1,150 @@
+/*
+    Incremental type checking benchmark.
+
+    usage: incrementalCheckBench [functions] [rounds]
+
+    Generates a program of `functions` functions like parallelCheckBench, checks it with
+    a checkCache, and then checks edited versions of it with that cache: one with a
+    change in the body of the middle function, one where the middle function takes
+    another parameter, so that its caller is checked again too, one with a global added
+    in front of all functions, which moves every body down a line, and one where the
+    global in an array dimension of the middle function is renamed, which leaves that
+    name unbound although the dimension is folded away in the checked body. Each checked
+    AST and its errors must be those of a full check of the edited program before
+    anything is reported. Reports the time of the checks and how many bodies each reused.
+*/
+#include <chrono>
+#include "parser/parser.hpp"
+#include "types/checkCache.hpp"
+#include "benchUtil.hpp"
+
+enum editKind {
+    EDIT_NONE,
+    EDIT_BODY,
+    EDIT_SIGNATURE,
+    EDIT_SHIFT,
+    EDIT_DIMENSION
+};
+
+std::string generateProgram(size_t functions, editKind edit) {
+    size_t edited = functions / 2;
+    std::stringstream code;
+    if(edit == EDIT_SHIFT) code << "int shift[1] = {0};\n";
+    code << "int " << (edit == EDIT_DIMENSION ? "size" : "dim") << " = 4;\n";
+    code << "int g0[8] = {0, 2};\n"
+         << "int f0(int x, int y) {\n    return x;\n}\n";
+    for(size_t i = 1; i < functions; i++) {
+        bool changed = i == edited;
+        if(i % 8 == 0) code << "int g" << i / 8 << "[8] = {" << i % 7 << ", 2};\n";
+        code << "int f" << i << "(int x, int y" << (changed && edit == EDIT_SIGNATURE ? ", int z" : "") << ") {\n"
+             << "    int a[4][3] = {{x, y}, {" << (changed && edit == EDIT_BODY ? "y" : "-x") << "}};\n"
+             << (changed ? "    int b[dim];\n" : "")
+             << "    int v = a[x][g" << i / 8 << "[y]];\n"
+             << "    int w = f" << i - 1 << "(v, -y);\n"
+             << "    while (!w) {\n"
+             << "        int u = a[w][v];\n"
+             << "        if (u) break;\n"
+             << "    }\n";
+        if(i % 16 == 0) code << "    int z = f" << i + 1 << "(w, v);\n";
+        code << "    return a[w][-v];\n"
+             << "}\n";
+    }
+    code << "int main() {\n    return f" << functions - 1 << "(1, 2);\n}\n";
+    return code.str();
+}
+
+struct checkResult {
+    flatAST flat;
+    std::string errors;
+    double seconds = 0;
+};
+
+// Checks file with cache, which may be nullptr. The trace of the checker is dropped.
+checkResult check(const sourceFile &file, checkCache *cache) {
+    astArena arena;
+    astArena::scope useArena(arena);
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+    tokenSource source(file);
+    parseResult result = Parse(source, builtinLRTable());
+    checkResult res;
+    if(result.node == nullptr) {
+        std::cout.rdbuf(console);
+        return res;
+    }
+    TypeChecker checker;
+    checker.setSource(file);
+    checker.setCache(cache);
+    auto begin = std::chrono::steady_clock::now();
+    checker.analyze(static_cast<program *>(result.node->ptr.get()));
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::stringbuf errors;
+    std::cout.rdbuf(&errors);
+    checker.dumpErrors(file.path);
+    std::cout.rdbuf(console);
+    res.errors = errors.str();
+    res.flat.fromTree(result.node->ptr.get());
+    return res;
+}
+
+// Whether both checks gave the same tree, types compared by their spelling.
+bool sameTree(const flatAST &a, const flatAST &b) {
+    if(a.kinds != b.kinds || a.ops != b.ops || a.flags != b.flags || a.lines != b.lines
+        || a.columns != b.columns || a.first != b.first || a.lists != b.lists) return false;
+    auto spelling = [](const flatAST &ast, uint32_t index) {
+        struct Type *type = ast.typeTable[index];
+        return type ? type->to_string() : std::string();
+    };
+    for(size_t n = 0; n < a.size(); n++) {
+        if(spelling(a, a.types[n]) != spelling(b, b.types[n])) return false;
+        // the slots that hold a type index
+        bool secondType = a.kinds[n] == FLAT_TYPE_CAST, thirdType = a.kinds[n] == FLAT_SUBSCRIPT;
+        if(secondType ? spelling(a, a.second[n]) != spelling(b, b.second[n]) : a.second[n] != b.second[n]) return false;
+        if(thirdType ? spelling(a, a.third[n]) != spelling(b, b.third[n]) : a.third[n] != b.third[n]) return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    size_t functions = std::max<size_t>(argc > 1 ? std::stoul(argv[1]) : 4096, 4);
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 3;
+
+    std::string code = generateProgram(functions, EDIT_NONE);
+    sourceFile file("generated.sy", code);
+    double fullTime = 1e30, firstTime = 1e30;
+    for(size_t r = 0; r < rounds; r++) {
+        fullTime = std::min(fullTime, check(file, nullptr).seconds);
+        checkCache cache;
+        firstTime = std::min(firstTime, check(file, &cache).seconds);
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:          " << functions << " functions, " << code.size() / 1024.0 << " KB\n"
+              << "full check:     " << std::setw(9) << fullTime * 1e3 << " ms\n"
+              << "filling cache:  " << std::setw(9) << firstTime * 1e3 << " ms\n";
+
+    const char *names[] = {"unchanged", "body edit", "signature", "shifted", "dimension"};
+    for(editKind edit : {EDIT_NONE, EDIT_BODY, EDIT_SIGNATURE, EDIT_SHIFT, EDIT_DIMENSION}) {
+        std::string editedCode = generateProgram(functions, edit);
+        sourceFile edited("generated.sy", editedCode);
+        checkResult full = check(edited, nullptr);
+        double best = 1e30;
+        size_t reused = 0, rechecked = 0;
+        for(size_t r = 0; r < rounds; r++) {
+            checkCache cache;
+            check(file, &cache);
+            checkResult res = check(edited, &cache);
+            if(res.errors != full.errors || !sameTree(res.flat, full.flat)) {
+                std::cout << names[edit] << ": the incremental check differs from a full one\n";
+                return 1;
+            }
+            best = std::min(best, res.seconds);
+            reused = cache.reused;
+            rechecked = cache.rechecked;
+        }
+        std::cout << std::left << std::setw(16) << std::string(names[edit]) + ":" << std::right
+                  << std::setw(9) << best * 1e3 << " ms, " << reused << " bodies reused, "
+                  << rechecked << " checked (" << fullTime / best << "x faster)\n";
+    }
+    return 0;
+}
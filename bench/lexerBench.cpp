@@ -0,0 +1,257 @@
+/*
+    Lexer throughput benchmark.
+
+    usage: lexerBench <file.sy> [copies] [rounds]
+
+    The input file is concatenated `copies` times into one large buffer. The table-driven
+    tokenize() and the substr/std::map scanner it replaced are then run `rounds` times
+    each, and the best round of each is reported in MB/s. Before timing, the two token
+    streams are compared token by token, and the memory held by each is reported.
+*/
+#include "lexer/lexer.hpp"
+#include "benchUtil.hpp"
+
+namespace legacy {
+
+// the token layout this benchmark measures against: one owned string per token
+struct ownedToken {
+    std::string value;
+    token::tokenType type;
+    std::pair<size_t, size_t> location;
+
+    ownedToken(token::tokenType type, std::string value, size_t x, size_t y)
+        :value(value), type(type), location({x, y}) {}
+};
+
+struct lexInfo
+{
+    std::vector<ownedToken> tokens;
+    std::vector<std::string> rows;
+};
+
+size_t read_id_keyword(const std::string &code, size_t start) {
+    size_t i = start;
+    std::string str;
+    while(isalpha(code[i]) || isdigit(code[i]) || code[i] == '_') {
+        str += code[i];
+        i++;
+    }
+    return i;
+}
+
+size_t read_num(const std::string &code, size_t start) {
+    size_t i = start;
+    std::string str;
+    if(code[i] == '0' && (code[i+1] == 'x' || code[i+1] == 'X')) {
+        i+=2;
+        while(i < code.size() && (isdigit(code[i]) || (tolower(code[i]) >= 'a' && tolower(code[i]) <= 'f')))
+            i++;
+    } else {
+        while(isdigit(code[i]) && i < code.size()) i++;
+    }
+    return i;
+}
+
+const std::map<std::string, token::tokenType> keywords = {
+    {"if", token::KW_IF},
+    {"else", token::KW_ELSE},
+    {"while", token::KW_WHILE},
+    {"for", token::KW_FOR},
+    {"return", token::KW_RETURN},
+    {"function", token::KW_FUNCTION},
+    {"break", token::KW_BREAK},
+    {"continue", token::KW_CONTINUE},
+    {"class", token::KW_CLASS},
+    {"struct", token::KW_STRUCT},
+    {"int", token::KW_INT},
+    {"void", token::KW_VOID},
+    {"float", token::KW_FLOAT},
+    {"char", token::KW_CHAR},
+    {"const", token::KW_CONST}
+};
+
+const std::map<std::string, token::tokenType> separators = {
+    {"(", token::tokenType::LPR},
+    {")", token::tokenType::RPR},
+    {"[", token::tokenType::LBK},
+    {"]", token::tokenType::RBK},
+    {"{", token::tokenType::LBC},
+    {"}", token::tokenType::RBC},
+    {",", token::tokenType::COMMA},
+    {";", token::tokenType::SEMICOLON}
+};
+
+const std::map<std::string, token::tokenType> operators = {
+    {"+", token::PLUS}, {"-", token::MINUS},
+    {"*", token::STAR}, {"/", token::SLASH},
+    {"%", token::PERCENT},
+    {"++", token::PLUS_PLUS}, {"--", token::MINUS_MINUS},
+    {"+=", token::PLUS_EQ}, {"-=", token::MINUS_EQ},
+    {"*=", token::STAR_EQ}, {"/=", token::SLASH_EQ},
+    {"%=", token::PERCENT_EQ},
+    {"==", token::EQ}, {"!=", token::NEQ},
+    {"<", token::LT}, {">", token::GT},
+    {"<=", token::LTE}, {">=", token::GTE},
+    {"&&", token::AND}, {"||", token::OR},
+    {"!", token::NOT},
+    {"&", token::BIT_AND}, {"|", token::BIT_OR},
+    {"^", token::BIT_XOR},
+    {"<<", token::SHL}, {">>", token::SHR},
+    {"=", token::tokenType::ASSIGN},
+    {".", token::tokenType::DOT},
+    {"->", token::tokenType::POINTER_ACC}
+};
+
+size_t read_operator(const std::string &code, size_t start) {
+    if(operators.count(code.substr(start, 1))) {
+        if(operators.count(code.substr(start, 2))) {
+            return start + 2;
+        }
+        return start + 1;
+    }
+    return start;
+}
+
+bool is_keyword(std::string str) {
+    std::cout << str << keywords.count(str) << "\n";
+    return keywords.count(str) > 0;
+}
+
+lexInfo tokenize(const std::string &code) {
+    size_t row = 1, col = 1, i = 0;
+    std::vector<ownedToken> tokens;
+
+    std::vector<std::string> rows;
+    size_t row_begin = 0;
+    while(i < code.size()) {
+        char cur = code[i];
+        if(code.substr(i, 2) == "/*") {
+            i += 2;
+            while(code.substr(i, 2) != "*/" && i < code.size()) i++;
+            i += 2;
+        } else if(cur == ' ') {
+            i++;
+            col++;
+        } else if(cur == '\n') {
+            rows.push_back(code.substr(row_begin, i - row_begin + 1));
+            i++;
+            row_begin = i;
+            row++;
+            col = 1;
+        } else if(isalpha(cur) || cur == '_'){
+            size_t end = read_id_keyword(code, i);
+            std::string str = code.substr(i, end - i);
+            if(is_keyword(str)) {
+                auto tokenType = keywords.at(str);
+                tokens.emplace_back(tokenType, str, row, col);
+            } else {
+                tokens.emplace_back(token::tokenType::ID, str, row, col);
+            }
+            col += end - i;
+            i = end;
+        } else if(isdigit(cur)){
+            size_t end = read_num(code, i);
+            tokens.emplace_back(token::tokenType::NUM, code.substr(i, end - i), row, col);
+            col += end - i;
+            i = end;
+        } else if(separators.find(std::string(1, cur)) != separators.end()) {
+            tokens.emplace_back(separators.at(std::string(1, cur)), std::string(1, code[i]), row, col);
+            col++;
+            i++;
+        } else if(code.substr(i, 2) == "//") {
+            while(code[i] != '\n' && i < code.size()) {
+                i++;
+                col++;
+            }
+        } else if(read_operator(code, i) > i) {
+            size_t end = read_operator(code, i);
+            tokens.emplace_back(operators.at(code.substr(i, end - i)), code.substr(i, end - i), row, col);
+            col += end - i;
+            i = end;
+        } else {
+            i++;
+        }
+    }
+    return lexInfo{
+        .tokens = tokens,
+        .rows = rows
+    };
+}
+
+} // namespace legacy
+
+// Locations are not compared: the legacy scanner did not count tabs, unknown characters
+// or lines inside block comments.
+bool sameTokens(const lexInfo &a, const legacy::lexInfo &b) {
+    if(a.size() != b.tokens.size()) return false;
+    for(size_t i = 0; i < a.size(); i++) {
+        const legacy::ownedToken &y = b.tokens[i];
+        if(a.kind(i) != y.type || a.text(i) != y.value) {
+            std::cout << "mismatch at token " << i << ":\n"
+                      << "  table-driven: " << token_serialize(a.at(i))
+                      << "  legacy:       " << token_serialize(token(y.type, y.value, y.location));
+            return false;
+        }
+    }
+    return true;
+}
+
+// Bytes held by the token stream itself, not counting the source buffer.
+size_t tokenBytes(const lexInfo &info) {
+    return info.kinds.capacity() * sizeof(uint8_t) + info.offsets.capacity() * sizeof(uint32_t)
+         + info.lengths.capacity() * sizeof(uint32_t);
+}
+
+size_t tokenBytes(const legacy::lexInfo &info) {
+    size_t bytes = info.tokens.capacity() * sizeof(legacy::ownedToken) + info.rows.capacity() * sizeof(std::string);
+    for(const auto &tok : info.tokens) {
+        if(tok.value.capacity() > 15) bytes += tok.value.capacity() + 1; // past the SSO buffer
+    }
+    for(const auto &row : info.rows) {
+        if(row.capacity() > 15) bytes += row.capacity() + 1;
+    }
+    return bytes;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cout << "usage: " << argv[0] << " <file.sy> [copies] [rounds]\n";
+        return 1;
+    }
+    size_t copies = argc > 2 ? std::stoul(argv[2]) : 64;
+    size_t rounds = argc > 3 ? std::stoul(argv[3]) : 5;
+
+    SourceManager sources;
+    std::string_view unit = sources.load(argv[1]).text;
+    std::string code;
+    code.reserve(unit.size() * copies);
+    for(size_t i = 0; i < copies; i++) {
+        code += unit;
+    }
+    sourceFile file(argv[1], code);
+    double mb = code.size() / (1024.0 * 1024.0);
+
+    // swallows the identifier dump of is_keyword while timing
+    nullBuffer sink;
+    std::streambuf *console = std::cout.rdbuf(&sink);
+    lexInfo fresh = tokenize(file);
+    legacy::lexInfo old = legacy::tokenize(code);
+    double tableTime = bestSeconds(rounds, [&] { tokenize(file); });
+    double legacyTime = bestSeconds(rounds, [&] { legacy::tokenize(code); });
+    std::cout.rdbuf(console);
+
+    if(!sameTokens(fresh, old)) {
+        std::cout << "token streams differ, not timing\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:        " << argv[1] << " x" << copies << " = " << mb << " MB, "
+              << fresh.size() << " tokens\n"
+              << "table-driven: " << std::setw(8) << mb / tableTime << " MB/s (" << tableTime * 1000 << " ms)\n"
+              << "legacy:       " << std::setw(8) << mb / legacyTime << " MB/s (" << legacyTime * 1000 << " ms)\n"
+              << "speedup:      " << legacyTime / tableTime << "x\n"
+              << "token memory: " << tokenBytes(fresh) / 1024 << " KB vs " << tokenBytes(old) / 1024 << " KB legacy ("
+              << double(tokenBytes(old)) / tokenBytes(fresh) << "x smaller)\n";
+    return 0;
+}
@@ -0,0 +1,55 @@
+/*
+    Parallel lexing scaling benchmark.
+
+    usage: lexerScalingBench <file.sy> [copies] [max threads] [rounds]
+
+    The input file is concatenated `copies` times into one synthetic source. tokenize()
+    is then run with 1, 2, 4, ... up to `max threads` threads (default: one per hardware
+    thread), `rounds` times each. Every parallel token stream is checked against the
+    serial one, and the best round is reported in MB/s with the speedup over 1 thread.
+*/
+#include <thread>
+#include "lexer/lexer.hpp"
+#include "benchUtil.hpp"
+
+bool sameTokens(const lexInfo &a, const lexInfo &b) {
+    return a.kinds == b.kinds && a.offsets == b.offsets && a.lengths == b.lengths;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cout << "usage: " << argv[0] << " <file.sy> [copies] [max threads] [rounds]\n";
+        return 1;
+    }
+    size_t copies = argc > 2 ? std::stoul(argv[2]) : 1024;
+    size_t maxThreads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t rounds = argc > 4 ? std::stoul(argv[4]) : 5;
+
+    SourceManager sources;
+    std::string_view unit = sources.load(argv[1]).text;
+    std::string code;
+    code.reserve(unit.size() * copies);
+    for(size_t i = 0; i < copies; i++) {
+        code += unit;
+    }
+    sourceFile file(argv[1], code);
+    double mb = code.size() / (1024.0 * 1024.0);
+
+    lexInfo serial = tokenize(file, 1);
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:   " << argv[1] << " x" << copies << " = " << mb << " MB, "
+              << serial.size() << " tokens\n";
+
+    double base = 0;
+    for(size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        if(!sameTokens(tokenize(file, threads), serial)) {
+            std::cout << threads << " threads: token stream differs from the serial one\n";
+            return 1;
+        }
+        double time = bestSeconds(rounds, [&] { tokenize(file, threads); });
+        if(threads == 1) base = time;
+        std::cout << std::setw(3) << threads << " threads: " << std::setw(8) << mb / time << " MB/s ("
+                  << time * 1000 << " ms), speedup " << base / time << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+    Parallel type checking benchmark.
+
+    usage: parallelCheckBench [functions] [max threads] [rounds]
+
+    Generates a program of `functions` functions with global arrays between them, where
+    every function calls the one before it and every 16th one also calls the one after
+    it, which is an error since that one is not declared yet. The program is type checked
+    with 1, 2, 4, ... up to `max threads` threads (default: one per hardware thread),
+    `rounds` times each. The output and the errors of every parallel check must be those
+    of the serial one, and the best round is reported with the speedup over 1 thread.
+    Rows with more threads than the machine has hardware threads are marked, as they can
+    only show the cost of the threads.
+    The generated code keeps to what the grammar accepts today, see visitorBench.
+*/
+#include <chrono>
+#include <thread>
+#include "parser/parser.hpp"
+
+std::string generateProgram(size_t functions) {
+    std::stringstream code;
+    code << "int g0[8] = {0, 2};\n"
+         << "int f0(int x, int y) {\n    return x;\n}\n";
+    for(size_t i = 1; i < functions; i++) {
+        if(i % 8 == 0) code << "int g" << i / 8 << "[8] = {" << i % 7 << ", 2};\n";
+        code << "int f" << i << "(int x, int y) {\n"
+             << "    int a[4][3] = {{x, y}, {-x}};\n"
+             << "    int v = a[x][g" << i / 8 << "[y]];\n"
+             << "    int w = f" << i - 1 << "(v, -y);\n"
+             << "    while (!w) {\n"
+             << "        int u = a[w][v];\n"
+             << "        if (u) break;\n"
+             << "    }\n";
+        if(i % 16 == 0) code << "    int z = f" << i + 1 << "(w, v);\n";
+        code << "    return a[w][-v];\n"
+             << "}\n";
+    }
+    code << "int main() {\n    return f" << functions - 1 << "(1, 2);\n}\n";
+    return code.str();
+}
+
+struct checkResult {
+    std::string output;
+    double seconds = 0;
+};
+
+// What the checker prints, its errors included, and the time of the check.
+checkResult check(const sourceFile &file, size_t threads) {
+    astArena arena;
+    astArena::scope useArena(arena);
+    std::stringbuf text;
+    std::streambuf *console = std::cout.rdbuf(&text);
+    tokenSource source(file);
+    parseResult result = Parse(source, builtinLRTable());
+    if(result.node == nullptr) {
+        std::cout.rdbuf(console);
+        return checkResult();
+    }
+
+    TypeChecker checker;
+    checker.setSource(file);
+    checker.setThreads(threads);
+    auto begin = std::chrono::steady_clock::now();
+    checker.analyze(static_cast<program *>(result.node->ptr.get()));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    checker.dumpErrors(file.path);
+    std::cout.rdbuf(console);
+    return checkResult{text.str(), seconds};
+}
+
+int main(int argc, char *argv[]) {
+    size_t functions = argc > 1 ? std::stoul(argv[1]) : 4096;
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxThreads = argc > 2 ? std::stoul(argv[2]) : hardware;
+    size_t rounds = argc > 3 ? std::stoul(argv[3]) : 5;
+
+    std::string code = generateProgram(std::max<size_t>(functions, 2));
+    sourceFile file("generated.sy", code);
+    std::string serial = check(file, 1).output;
+    if(serial.empty()) {
+        std::cout << "the generated program does not parse\n";
+        return 1;
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:   " << functions << " functions, " << code.size() / 1024.0 << " KB, "
+              << hardware << " hardware threads\n";
+
+    double base = 0;
+    for(size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double best = 1e30;
+        for(size_t r = 0; r < rounds; r++) {
+            checkResult result = check(file, threads);
+            if(result.output != serial) {
+                std::cout << threads << " threads: the check differs from the serial one\n";
+                return 1;
+            }
+            best = std::min(best, result.seconds);
+        }
+        if(threads == 1) base = best;
+        std::cout << std::setw(3) << threads << " threads: " << std::setw(9) << best * 1e3 << " ms ("
+                  << base / best << "x)" << (threads > hardware ? " oversubscribed" : "") << "\n";
+    }
+    return 0;
+}
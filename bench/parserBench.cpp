@@ -0,0 +1,186 @@
+/*
+    Parser hot loop benchmark.
+
+    usage: parserBench <table.csv> <file.sy> [copies] [rounds]
+
+    The input file is concatenated `copies` times and tokenized once up front. A bare
+    LR recognizer (state stack only, no semantic actions) is then run over the token
+    kinds with two tables: the unordered_map rows of importLRTableFromCSV, looked up with
+    count() and at() as Parse() used to, and the dense matrices of builtinLRTable().
+    This isolates the cost of the table lookups. The full Parse(), which also builds the
+    AST, is timed last for scale. Both recognizers must accept the input in the same
+    number of steps before anything is reported.
+
+    Then every compressLRTable level is reported with its size, the recognizer time and
+    the full Parse() time, to pick the trade-off between table footprint and lookup cost.
+*/
+#include "parser/parser.hpp"
+#include "benchUtil.hpp"
+
+// Left-hand side and right-hand side length of every rule, by rule number.
+std::vector<symbolType> ruleLeft;
+std::vector<uint32_t> ruleLength;
+
+struct mapTable {
+    const LRTable &table;
+    bool step(uint32_t state, symbolType sym, action &a) const {
+        if(table[state].count(sym) == 0) return false;
+        a = table[state].at(sym);
+        return true;
+    }
+    uint32_t go(uint32_t state, symbolType sym) const {
+        return table[state].at(sym).n;
+    }
+};
+
+struct denseTable {
+    const lrTableView &table;
+    bool step(uint32_t state, symbolType sym, action &a) const {
+        packedAction word = table.actionAt(state, sym);
+        if(word == lrNoAction) return false;
+        a = unpackAction(word);
+        return true;
+    }
+    uint32_t go(uint32_t state, symbolType sym) const {
+        return table.gotoAt(state, sym);
+    }
+};
+
+struct compressedTable {
+    const compressedLRTable &table;
+    bool step(uint32_t state, symbolType sym, action &a) const {
+        packedAction word = table.actionAt(state, sym);
+        if(word == lrNoAction) return false;
+        a = unpackAction(word);
+        return true;
+    }
+    uint32_t go(uint32_t state, symbolType sym) const {
+        return table.gotoAt(state, sym);
+    }
+};
+
+// Returns the number of steps taken to accept input, or 0 on a syntax error.
+template <typename Table>
+size_t recognize(const Table &table, const std::vector<symbolType> &input, std::vector<uint32_t> &stack) {
+    stack.clear();
+    stack.push_back(0);
+    size_t pos = 0, steps = 0;
+    while(true) {
+        action a;
+        steps++;
+        if(!table.step(stack.back(), input[pos], a)) return 0;
+        switch(a.type) {
+            case SHIFT:
+                stack.push_back(a.n);
+                pos++;
+                break;
+            case REDUCE:
+                stack.resize(stack.size() - ruleLength[a.n]);
+                stack.push_back(table.go(stack.back(), ruleLeft[a.n]));
+                break;
+            case ACC:
+                return input[pos] == END_OF_FILE ? steps : 0;
+            default:
+                return 0;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 3) {
+        std::cout << "usage: " << argv[0] << " <table.csv> <file.sy> [copies] [rounds]\n";
+        return 1;
+    }
+    size_t copies = argc > 3 ? std::stoul(argv[3]) : 4096;
+    size_t rounds = argc > 4 ? std::stoul(argv[4]) : 5;
+
+    for(const auto &r : parserRules) {
+        ruleLeft.push_back(r.left);
+        ruleLength.push_back(r.right.size());
+    }
+
+    SourceManager sources;
+    std::string_view unit = sources.load(argv[2]).text;
+    std::string code;
+    code.reserve(unit.size() * copies);
+    for(size_t i = 0; i < copies; i++) {
+        code += unit;
+    }
+    sourceFile file(argv[2], code);
+
+    lexInfo tokens = tokenize(file);
+    std::vector<symbolType> input;
+    input.reserve(tokens.size() + 1);
+    for(size_t i = 0; i < tokens.size(); i++) {
+        input.push_back(tokenToSymbol(token::tokenType(tokens.kind(i))));
+    }
+    input.push_back(END_OF_FILE);
+
+    LRTable mapped = importLRTableFromCSV(argv[1]);
+    lrTableView dense = builtinLRTable();
+    std::vector<uint32_t> stack;
+    size_t mapSteps = recognize(mapTable{mapped}, input, stack);
+    size_t denseSteps = recognize(denseTable{dense}, input, stack);
+    if(mapSteps == 0 || mapSteps != denseSteps) {
+        std::cout << "recognizers disagree (" << mapSteps << " vs " << denseSteps << " steps), not timing\n";
+        return 1;
+    }
+
+    size_t sink = 0;
+    double mapTime = bestSeconds(rounds, [&] { sink += recognize(mapTable{mapped}, input, stack); });
+    double denseTime = bestSeconds(rounds, [&] { sink += recognize(denseTable{dense}, input, stack); });
+
+    // Parse() reports the number of ASTs on stdout
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+    double parseTime = bestSeconds(rounds, [&] {
+        astArena arena;
+        astArena::scope useArena(arena);
+        tokenSource source(file);
+        sink += Parse(source, dense).node != nullptr;
+    });
+    std::cout.rdbuf(console);
+
+    const char *levelNames[] = {"dense", "default reduce", "merged rows", "comb"};
+    std::vector<compressedLRTable> levels;
+    for(lrCompression level : {LR_DENSE, LR_DEFAULT_REDUCE, LR_MERGED_ROWS, LR_COMB}) {
+        levels.push_back(compressLRTable(dense, level));
+        size_t steps = recognize(compressedTable{levels.back()}, input, stack);
+        if(steps != denseSteps) {
+            std::cout << levelNames[level] << " table disagrees (" << steps << " steps), not timing\n";
+            return 1;
+        }
+    }
+    std::vector<double> levelTime, levelParseTime;
+    for(const auto &table : levels) {
+        levelTime.push_back(bestSeconds(rounds, [&] { sink += recognize(compressedTable{table}, input, stack); }));
+        console = std::cout.rdbuf(&null);
+        levelParseTime.push_back(bestSeconds(rounds, [&] {
+            astArena arena;
+            astArena::scope useArena(arena);
+            tokenSource source(file);
+            sink += Parse(source, table).node != nullptr;
+        }));
+        std::cout.rdbuf(console);
+    }
+
+    double mb = code.size() / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:         " << argv[2] << " x" << copies << " = " << mb << " MB, "
+              << tokens.size() << " tokens, " << denseSteps << " parser steps\n"
+              << "map rows:      " << std::setw(8) << mapTime * 1e9 / denseSteps << " ns/step ("
+              << mapTime * 1000 << " ms)\n"
+              << "dense matrix:  " << std::setw(8) << denseTime * 1e9 / denseSteps << " ns/step ("
+              << denseTime * 1000 << " ms, " << mapTime / denseTime << "x faster)\n"
+              << "full Parse():  " << std::setw(8) << parseTime * 1e9 / denseSteps << " ns/step ("
+              << parseTime * 1000 << " ms, lexing and AST included)\n"
+              << "\nlevel              table KB   recognizer ns/step   Parse() ns/step\n";
+    for(size_t i = 0; i < levels.size(); i++) {
+        std::cout << std::left << std::setw(16) << levelNames[i] << std::right
+                  << std::setw(11) << levels[i].bytes() / 1024.0
+                  << std::setw(21) << levelTime[i] * 1e9 / denseSteps
+                  << std::setw(18) << levelParseTime[i] * 1e9 / denseSteps << "\n";
+    }
+    std::cout << "checksum: " << sink << "\n";
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+    Symbol table benchmark.
+
+    usage: symbolTableBench [depth] [rounds]
+
+    Opens `depth` nested scopes that each bind a few names, one of them shadowing a name
+    of every outer scope, looks up names of all the enclosing scopes at every level and
+    closes the scopes again. This runs on SymbolTable and on the table it replaced, a
+    vector of one unordered_map per scope, and the two must find the same symbols. Then
+    type checks a generated function whose blocks are nested `depth` deep.
+*/
+#include <chrono>
+#include "parser/parser.hpp"
+#include "symbolTable/symbolTable.hpp"
+#include "benchUtil.hpp"
+
+// The previous SymbolTable: a scope is a map, and a lookup searches them innermost first.
+struct scopeMaps {
+    std::vector<std::unordered_map<symId, Symbol>> scopes{1};
+
+    bool insert(symId symbol, Symbol sym) { return scopes.back().emplace(symbol, sym).second; }
+    bool exists(symId symbol) {
+        for(auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+            if(it->find(symbol) != it->end()) return true;
+        }
+        return false;
+    }
+    Symbol getValue(symId symbol) {
+        for(auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+            auto found = it->find(symbol);
+            if(found != it->end()) return found->second;
+        }
+        return Symbol{Unknown, nullptr, nullptr};
+    }
+    void beginScope() { scopes.emplace_back(); }
+    void endScope() { scopes.pop_back(); }
+};
+
+// Exists then getValue, as the checker resolved an identifier before lookup.
+struct Type *resolve(scopeMaps &table, symId name) {
+    return table.exists(name) ? table.getValue(name).type : nullptr;
+}
+
+struct Type *resolve(SymbolTable &table, symId name) {
+    auto sym = table.lookup(name);
+    return sym ? sym->type : nullptr;
+}
+
+constexpr size_t namesPerScope = 4;
+
+// The symbols found, summed up so that both tables can be compared.
+template <typename Table>
+size_t nestedScopes(Table &table, const std::vector<symId> &names, size_t depth) {
+    struct Type *types[2] = {TypeFactory::getInt(), TypeFactory::getVoid()};
+    size_t found = 0;
+    for(size_t level = 0; level < depth; level++) {
+        table.beginScope();
+        for(size_t i = 0; i < namesPerScope; i++) {
+            symId name = i == 0 ? names[0] : names[level * namesPerScope + i];
+            table.insert(name, Symbol{VARIABLE, types[level % 2], nullptr});
+        }
+        // a name of every enclosing scope, the shadowed one and one that is not bound
+        for(size_t outer = 0; outer <= level; outer++) {
+            found += resolve(table, names[outer * namesPerScope + 1]) == types[outer % 2];
+        }
+        found += resolve(table, names[0]) == types[level % 2];
+        found += resolve(table, names.back()) == nullptr;
+    }
+    for(size_t level = 0; level < depth; level++) table.endScope();
+    return found;
+}
+
+std::string generateProgram(size_t depth) {
+    std::stringstream code;
+    code << "int main() {\n    int v0 = 0;\n";
+    for(size_t i = 1; i <= depth; i++) {
+        code << "{\n    int v" << i << " = v" << i - 1 << ";\n"
+             << "    int w = v0;\n";
+    }
+    for(size_t i = 0; i < depth; i++) code << "}\n";
+    code << "    return v0;\n}\n";
+    return code.str();
+}
+
+double seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t depth = argc > 1 ? std::stoul(argv[1]) : 512;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    std::vector<symId> names;
+    for(size_t i = 0; i <= depth * namesPerScope; i++) {
+        names.push_back(Interner::intern("name" + std::to_string(i)));
+    }
+    size_t lookups = depth * (depth + 1) / 2 + 2 * depth;
+
+    double flatTime = 1e30, mapsTime = 1e30;
+    size_t flatFound = 0, mapsFound = 0;
+    for(size_t r = 0; r < rounds; r++) {
+        auto begin = std::chrono::steady_clock::now();
+        SymbolTable flat;
+        flatFound = nestedScopes(flat, names, depth);
+        flatTime = std::min(flatTime, seconds(begin));
+        begin = std::chrono::steady_clock::now();
+        scopeMaps maps;
+        mapsFound = nestedScopes(maps, names, depth);
+        mapsTime = std::min(mapsTime, seconds(begin));
+    }
+    if(flatFound != mapsFound || flatFound != lookups) {
+        std::cout << "the tables disagree (" << flatFound << ", " << mapsFound << " of "
+                  << lookups << " found)\n";
+        return 1;
+    }
+
+    std::string code = generateProgram(depth);
+    sourceFile file("generated.sy", code);
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+    double checkTime = 1e30;
+    bool typeErrors = false;
+    for(size_t r = 0; r < rounds; r++) {
+        astArena arena;
+        astArena::scope useArena(arena);
+        tokenSource source(file);
+        parseResult result = Parse(source, builtinLRTable());
+        if(result.node == nullptr) {
+            std::cout.rdbuf(console);
+            std::cout << "the generated program does not parse\n";
+            return 1;
+        }
+        TypeChecker checker;
+        checker.setSource(file);
+        auto begin = std::chrono::steady_clock::now();
+        checker.analyze(static_cast<program *>(result.node->ptr.get()));
+        checkTime = std::min(checkTime, seconds(begin));
+        typeErrors = checker.hasTypeError();
+    }
+    std::cout.rdbuf(console);
+    if(typeErrors) {
+        std::cout << "the generated program does not type check\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:         " << depth << " nested scopes, " << lookups << " lookups\n"
+              << "SymbolTable:   " << std::setw(9) << flatTime * 1e3 << " ms, "
+              << flatTime * 1e9 / lookups << " ns/lookup\n"
+              << "scope maps:    " << std::setw(9) << mapsTime * 1e3 << " ms, "
+              << mapsTime * 1e9 / lookups << " ns/lookup\n"
+              << "TypeChecker:   " << std::setw(9) << checkTime * 1e3 << " ms for the nested function\n";
+    return 0;
+}
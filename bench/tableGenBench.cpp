@@ -0,0 +1,25 @@
+/*
+    Parse table generator benchmark.
+
+    usage: tableGenBench [rounds]
+
+    Times buildLRTable on parserRules in LR(1) and LALR(1) mode, which is what a grammar
+    edit costs at build time, and reports the number of states and the size of the
+    dense binary table of each.
+*/
+#include "parser/parser.hpp"
+#include "benchUtil.hpp"
+
+int main(int argc, char *argv[]) {
+    size_t rounds = argc > 1 ? std::stoul(argv[1]) : 10;
+
+    std::cout << std::fixed << std::setprecision(2) << parserRules.size() << " rules\n";
+    for(lrTableMode mode : {LR1_TABLE, LALR1_TABLE}) {
+        LRTable table;
+        double time = bestSeconds(rounds, [&] { table = buildLRTable(parserRules, mode); });
+        std::cout << (mode == LR1_TABLE ? "LR(1):   " : "LALR(1): ") << std::setw(8) << time * 1e3 << " ms, "
+                  << std::setw(4) << table.size() << " states, "
+                  << serializeLRTable(table, grammarHash(parserRules), mode).size() * sizeof(uint32_t) / 1024.0 << " KB\n";
+    }
+    return 0;
+}
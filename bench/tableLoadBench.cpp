@@ -0,0 +1,65 @@
+/*
+    Parse table startup benchmark.
+
+    usage: tableLoadBench <table.csv> <table.bin> [rounds]
+
+    Times what every compiler run pays before it can parse: importLRTableFromCSV versus
+    mapping the binary table. The mapped table is only validated, not read, so the
+    first lookups also pay for faulting its pages in; the second column includes one
+    walk over every row to account for that. Before timing, every action of the two
+    tables is compared.
+*/
+#include "parser/parser.hpp"
+#include "benchUtil.hpp"
+
+bool sameTable(const LRTable &csv, const lrTableView &bin) {
+    if(csv.size() != bin.numStates()) return false;
+    for(size_t state = 0; state < csv.size(); state++) {
+        for(size_t sym = 0; sym < SYMBOL_COUNT; sym++) {
+            action a;
+            bool found = bin.lookup(state, symbolType(sym), a);
+            auto it = csv[state].find(symbolType(sym));
+            // shifts of nonterminals without productions are dropped from the binary table
+            if(it != csv[state].end() && it->second.type != GOTO && sym >= firstNonterminal) continue;
+            if(found != (it != csv[state].end())) return false;
+            if(found && (a.type != it->second.type || a.n != it->second.n)) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 3) {
+        std::cout << "usage: " << argv[0] << " <table.csv> <table.bin> [rounds]\n";
+        return 1;
+    }
+    size_t rounds = argc > 3 ? std::stoul(argv[3]) : 20;
+
+    {
+        mappedLRTable bin(argv[2]);
+        if(!sameTable(importLRTableFromCSV(argv[1]), bin.view)) {
+            std::cout << "tables differ, not timing\n";
+            return 1;
+        }
+    }
+
+    size_t sink = 0;
+    double csvTime = bestSeconds(rounds, [&] { sink += importLRTableFromCSV(argv[1]).size(); });
+    double mapTime = bestSeconds(rounds, [&] { mappedLRTable bin(argv[2]); sink += bin.view.numStates(); });
+    double touchTime = bestSeconds(rounds, [&] {
+        mappedLRTable bin(argv[2]);
+        for(size_t state = 0; state < bin.view.numStates(); state++) {
+            action a;
+            sink += bin.view.lookup(state, END_OF_FILE, a);
+        }
+    });
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "csv import:        " << std::setw(9) << csvTime * 1e3 << " ms\n"
+              << "binary map:        " << std::setw(9) << mapTime * 1e3 << " ms ("
+              << csvTime / mapTime << "x faster)\n"
+              << "binary map + walk: " << std::setw(9) << touchTime * 1e3 << " ms ("
+              << csvTime / touchTime << "x faster)\n"
+              << "checksum: " << sink << "\n";
+    return 0;
+}
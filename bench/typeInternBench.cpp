@@ -0,0 +1,83 @@
+/*
+    Type hash-consing benchmark.
+
+    usage: typeInternBench [functions] [rounds]
+
+    Generates a program of `functions` functions that declare arrays of a few shapes and
+    subscript them, so that the checker infers array and pointer types over and over, and
+    type checks it. Reports the time of the TypeChecker, the heap it allocates, and the
+    number of canonical types TypeFactory holds afterwards. The generated code keeps to
+    what the grammar accepts today, see visitorBench.
+*/
+#include <chrono>
+#include <malloc.h>
+#include "parser/parser.hpp"
+#include "benchUtil.hpp"
+
+std::string generateProgram(size_t functions) {
+    std::stringstream code;
+    for(size_t i = 0; i < functions; i++) {
+        code << "int f" << i << "() {\n"
+             << "    int a[4][3][2] = {1, 2, 3, " << i % 5 << "};\n"
+             << "    int b[3][2] = {{1, 2}, {3, 4}};\n"
+             << "    int c[2] = {a[1][2][1], b[2][0]};\n"
+             << "    int d = a[3][0][1];\n"
+             << "    int e = a[d][1][c[1]];\n"
+             << "    while (e) {\n"
+             << "        int g[4][3][2] = {d, e};\n"
+             << "        int h = g[e][b[1][1]][-d];\n"
+             << "        if (!h) break;\n"
+             << "    }\n"
+             << "    return b[c[0]][a[0][0][0]];\n"
+             << "}\n";
+    }
+    code << "int main() {\n    return f0();\n}\n";
+    return code.str();
+}
+
+int main(int argc, char *argv[]) {
+    size_t functions = argc > 1 ? std::stoul(argv[1]) : 4096;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    std::string code = generateProgram(functions);
+    sourceFile file("generated.sy", code);
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+
+    double checkTime = 1e30;
+    size_t heap = 0;
+    bool typeErrors = false;
+    for(size_t r = 0; r < rounds; r++) {
+        astArena arena;
+        astArena::scope useArena(arena);
+        tokenSource source(file);
+        parseResult result = Parse(source, builtinLRTable());
+        if(result.node == nullptr) {
+            std::cout.rdbuf(console);
+            std::cout << "the generated program does not parse\n";
+            return 1;
+        }
+        TypeChecker checker;
+        checker.setSource(file);
+        size_t before = mallinfo2().uordblks;
+        auto begin = std::chrono::steady_clock::now();
+        checker.analyze(static_cast<program *>(result.node->ptr.get()));
+        checkTime = std::min(checkTime, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        size_t after = mallinfo2().uordblks;
+        // the first round also creates the canonical types, later ones reuse them
+        if(r == 0) heap = after > before ? after - before : 0;
+        typeErrors = checker.hasTypeError();
+    }
+    std::cout.rdbuf(console);
+    if(typeErrors) {
+        std::cout << "the generated program does not type check\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:           " << functions << " functions\n"
+              << "TypeChecker:     " << std::setw(9) << checkTime * 1e3 << " ms\n"
+              << "heap in check:   " << std::setw(9) << heap / 1024.0 << " KiB\n"
+              << "canonical types: " << std::setw(6) << TypeFactory::canonicalCount() << "\n";
+    return 0;
+}
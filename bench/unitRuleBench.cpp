@@ -0,0 +1,155 @@
+/*
+    Unit rule bypass benchmark.
+
+    usage: unitRuleBench <file.sy> [copies] [rounds]
+
+    Builds the LR(1) table of parserRules with and without bypassUnitRules and runs an LR
+    recognizer over the input, concatenated `copies` times, with each, counting the
+    reductions made by every rule. The counts are reported side by side for the rules
+    that reduce at all, followed by the reductions per token, the number of states and the
+    time of the recognizer and of the full Parse() with either table. Both tables must
+    accept the input and Parse() must build the same AST with them before anything is
+    reported.
+*/
+#include "parser/parser.hpp"
+#include "benchUtil.hpp"
+
+// Returns the number of steps taken to accept input, or 0 on a syntax error. With
+// counts, the reductions by each rule are added to it.
+size_t recognize(const lrTableView &table, const std::vector<symbolType> &input, std::vector<uint32_t> &stack,
+                 std::vector<size_t> *counts) {
+    stack.clear();
+    stack.push_back(0);
+    size_t pos = 0, steps = 0;
+    while(true) {
+        packedAction word = table.actionAt(stack.back(), input[pos]);
+        steps++;
+        if(word == lrNoAction) return 0;
+        action a = unpackAction(word);
+        switch(a.type) {
+            case SHIFT:
+                stack.push_back(a.n);
+                pos++;
+                break;
+            case REDUCE:
+                if(counts) (*counts)[a.n]++;
+                stack.resize(stack.size() - parserRules[a.n].right.size());
+                stack.push_back(table.gotoAt(stack.back(), parserRules[a.n].left));
+                break;
+            case ACC:
+                return input[pos] == END_OF_FILE ? steps : 0;
+            default:
+                return 0;
+        }
+    }
+}
+
+// The AST Parse() builds with table, as printed, or an empty string on a syntax error.
+std::string printedAST(const sourceFile &file, const lrTableView &table) {
+    std::stringstream printed;
+    std::streambuf *console = std::cout.rdbuf(printed.rdbuf());
+    {
+        astArena arena;
+        astArena::scope useArena(arena);
+        tokenSource source(file);
+        parseResult result = Parse(source, table);
+        printed.str("");
+        if(result.node != nullptr) result.node->ptr->printAST("", "");
+    }
+    std::cout.rdbuf(console);
+    return printed.str();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cout << "usage: " << argv[0] << " <file.sy> [copies] [rounds]\n";
+        return 1;
+    }
+    size_t copies = argc > 2 ? std::stoul(argv[2]) : 4096;
+    size_t rounds = argc > 3 ? std::stoul(argv[3]) : 5;
+
+    SourceManager sources;
+    std::string_view unit = sources.load(argv[1]).text;
+    std::string code;
+    code.reserve(unit.size() * copies);
+    for(size_t i = 0; i < copies; i++) {
+        code += unit;
+    }
+    sourceFile file(argv[1], code);
+    sourceFile single(argv[1], unit);
+
+    lexInfo tokens = tokenize(file);
+    std::vector<symbolType> input;
+    input.reserve(tokens.size() + 1);
+    for(size_t i = 0; i < tokens.size(); i++) {
+        input.push_back(tokenToSymbol(token::tokenType(tokens.kind(i))));
+    }
+    input.push_back(END_OF_FILE);
+
+    uint64_t hash = grammarHash(parserRules);
+    LRTable plain = buildLRTable(parserRules);
+    LRTable bypassed = bypassUnitRules(plain, parserRules, passThroughUnitRules());
+    std::vector<uint32_t> plainImage = serializeLRTable(plain, hash, LR1_TABLE);
+    std::vector<uint32_t> bypassedImage = serializeLRTable(bypassed, hash, LR1_TABLE);
+    lrTableView plainView = viewLRTable(plainImage.data(), plainImage.size() * sizeof(uint32_t));
+    lrTableView bypassedView = viewLRTable(bypassedImage.data(), bypassedImage.size() * sizeof(uint32_t));
+
+    std::vector<uint32_t> stack;
+    std::vector<size_t> before(parserRules.size()), after(parserRules.size());
+    size_t plainSteps = recognize(plainView, input, stack, &before);
+    size_t bypassedSteps = recognize(bypassedView, input, stack, &after);
+    if(plainSteps == 0 || bypassedSteps == 0) {
+        std::cout << "a table rejects the input, not timing\n";
+        return 1;
+    }
+    std::string plainAST = printedAST(single, plainView);
+    if(plainAST.empty() || plainAST != printedAST(single, bypassedView)) {
+        std::cout << "the tables build different ASTs, not timing\n";
+        return 1;
+    }
+
+    size_t sink = 0;
+    double plainTime = bestSeconds(rounds, [&] { sink += recognize(plainView, input, stack, nullptr); });
+    double bypassedTime = bestSeconds(rounds, [&] { sink += recognize(bypassedView, input, stack, nullptr); });
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+    auto parseWith = [&](const lrTableView &table) {
+        return bestSeconds(rounds, [&] {
+            astArena arena;
+            astArena::scope useArena(arena);
+            tokenSource source(file);
+            sink += Parse(source, table).node != nullptr;
+        });
+    };
+    double plainParseTime = parseWith(plainView);
+    double bypassedParseTime = parseWith(bypassedView);
+    std::cout.rdbuf(console);
+
+    std::cout << "input: " << argv[1] << " x" << copies << ", " << tokens.size() << " tokens\n\n"
+              << "rule                                            before       after\n";
+    size_t totalBefore = 0, totalAfter = 0;
+    for(size_t i = 0; i < parserRules.size(); i++) {
+        totalBefore += before[i];
+        totalAfter += after[i];
+        if(before[i] == 0) continue;
+        std::stringstream name;
+        name << std::setw(3) << i << " " << symbolTypeNames.at(parserRules[i].left) << " ->";
+        for(auto sym : parserRules[i].right) name << " " << symbolTypeNames.at(sym);
+        std::cout << std::left << std::setw(44) << name.str().substr(0, 43) << std::right
+                  << std::setw(12) << before[i] << std::setw(12) << after[i] << "\n";
+    }
+    std::cout << std::left << std::setw(44) << "total" << std::right
+              << std::setw(12) << totalBefore << std::setw(12) << totalAfter << "\n\n"
+              << std::fixed << std::setprecision(2)
+              << "                    plain    bypassed\n"
+              << "reductions/token " << std::setw(8) << double(totalBefore) / tokens.size()
+              << std::setw(12) << double(totalAfter) / tokens.size() << "\n"
+              << "states           " << std::setw(8) << plain.size() << std::setw(12) << bypassed.size() << "\n"
+              << "table KB         " << std::setw(8) << plainImage.size() * sizeof(uint32_t) / 1024.0
+              << std::setw(12) << bypassedImage.size() * sizeof(uint32_t) / 1024.0 << "\n"
+              << "recognizer ms    " << std::setw(8) << plainTime * 1e3 << std::setw(12) << bypassedTime * 1e3 << "\n"
+              << "Parse() ms       " << std::setw(8) << plainParseTime * 1e3
+              << std::setw(12) << bypassedParseTime * 1e3 << "\n"
+              << "checksum: " << sink << "\n";
+    return 0;
+}
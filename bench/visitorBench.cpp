@@ -0,0 +1,182 @@
+/*
+    AST visitor benchmark.
+
+    usage: visitorBench [functions] [rounds]
+
+    Generates a program of `functions` small functions and parses it. Reports the time
+    per node of a pass that only counts the nodes, once dispatched by an ASTVisitor and
+    once by a chain of dynamic_casts, and the time of the TypeChecker over the whole
+    program, which is a fresh parse in every round since checking inserts casts. The
+    functions keep to what the grammar accepts today: definitions with initializers,
+    calls, subscripts, unary operators, if and while, but no assignments or binary
+    operators.
+*/
+#include <chrono>
+#include "parser/parser.hpp"
+#include "benchUtil.hpp"
+
+std::string generateProgram(size_t functions) {
+    std::stringstream code;
+    for(size_t i = 0; i < functions; i++) {
+        code << "int f" << i << "() {\n"
+             << "    int a[4][2] = {{1, 2}, {3, 4}, 5, 6, 7, " << i % 7 << "};\n"
+             << "    int b = a[1][0];\n"
+             << "    int c = " << (i ? "f" + std::to_string(i - 1) + "()" : "0") << ";\n"
+             << "    while (b) {\n"
+             << "        int d[3] = {b, a[2][1], -c};\n"
+             << "        if (!c) break;\n"
+             << "        else { int e = d[2]; }\n"
+             << "    }\n"
+             << "    return b;\n"
+             << "}\n";
+    }
+    code << "int main() {\n    return f0();\n}\n";
+    return code.str();
+}
+
+struct countVisitor : ASTVisitor<countVisitor, size_t> {
+    size_t count(node *n) { return n ? dispatch(n) : 0; }
+    template <typename T>
+    size_t count(const std::vector<T> &nodes) {
+        size_t res = 0;
+        for(auto &n : nodes) res += count(&*n);
+        return res;
+    }
+
+    size_t visit(program *n) { return 1 + count(n->children); }
+    size_t visit(int_literal *n) { return 1; }
+    size_t visit(unary_expr *n) { return 1 + count(n->operand.get()); }
+    size_t visit(binary_expr *n) { return 1 + count(n->left.get()) + count(n->right.get()); }
+    size_t visit(subscript_expr *n) { return 1 + count(n->list.get()) + count(n->sub.get()); }
+    size_t visit(identifier *n) { return 1; }
+    size_t visit(expr_stmt *n) { return 1 + count(n->ptr.get()); }
+    size_t visit(if_else_stmt *n) {
+        return 1 + count(n->cond.get()) + count(n->if_branch.get()) + count(n->else_branch.get());
+    }
+    size_t visit(while_stmt *n) { return 1 + count(n->cond.get()) + count(n->body.get()); }
+    size_t visit(break_stmt *n) { return 1; }
+    size_t visit(continue_stmt *n) { return 1; }
+    size_t visit(return_stmt *n) { return 1 + count(n->value.get()); }
+    size_t visit(block_stmt *n) { return 1 + count(n->items); }
+    size_t visit(fun_call *n) { return 1 + count(n->args); }
+    size_t visit(func_def *n) { return 1 + count(n->body); }
+    size_t visit(var_def *n) { return 1 + count(n->init_val.get()); }
+    size_t visit(var_decl *n) { return 1 + count(n->defs); }
+    size_t visit(init_val *n) { return 1 + count(n->scalar.get()) + count(n->children); }
+    size_t visit(class_def *n) { return 1 + count(n->children); }
+    size_t visit(member_access *n) { return 1 + count(n->exp.get()) + count(n->args); }
+    size_t visit(pointer_acc *n) { return 1 + count(n->exp.get()) + count(n->args); }
+    size_t visit(type_cast *n) { return 1 + count(n->exp.get()); }
+};
+
+// The same pass written without a visitor, finding the class of each node.
+size_t countByCasts(node *n) {
+    if(n == nullptr) return 0;
+    size_t res = 1;
+    if(program *p = dynamic_cast<program *>(n)) {
+        for(node *child : p->children) res += countByCasts(child);
+    } else if(unary_expr *p = dynamic_cast<unary_expr *>(n)) {
+        res += countByCasts(p->operand.get());
+    } else if(binary_expr *p = dynamic_cast<binary_expr *>(n)) {
+        res += countByCasts(p->left.get()) + countByCasts(p->right.get());
+    } else if(subscript_expr *p = dynamic_cast<subscript_expr *>(n)) {
+        res += countByCasts(p->list.get()) + countByCasts(p->sub.get());
+    } else if(expr_stmt *p = dynamic_cast<expr_stmt *>(n)) {
+        res += countByCasts(p->ptr.get());
+    } else if(if_else_stmt *p = dynamic_cast<if_else_stmt *>(n)) {
+        res += countByCasts(p->cond.get()) + countByCasts(p->if_branch.get()) + countByCasts(p->else_branch.get());
+    } else if(while_stmt *p = dynamic_cast<while_stmt *>(n)) {
+        res += countByCasts(p->cond.get()) + countByCasts(p->body.get());
+    } else if(return_stmt *p = dynamic_cast<return_stmt *>(n)) {
+        res += countByCasts(p->value.get());
+    } else if(block_stmt *p = dynamic_cast<block_stmt *>(n)) {
+        for(auto &item : p->items) res += countByCasts(item.get());
+    } else if(fun_call *p = dynamic_cast<fun_call *>(n)) {
+        for(auto &arg : p->args) res += countByCasts(arg.get());
+    } else if(func_def *p = dynamic_cast<func_def *>(n)) {
+        for(auto &item : p->body) res += countByCasts(item.get());
+    } else if(var_def *p = dynamic_cast<var_def *>(n)) {
+        res += countByCasts(p->init_val.get());
+    } else if(var_decl *p = dynamic_cast<var_decl *>(n)) {
+        for(auto &def : p->defs) res += countByCasts(def.get());
+    } else if(init_val *p = dynamic_cast<init_val *>(n)) {
+        res += countByCasts(p->scalar.get());
+        for(auto &child : p->children) res += countByCasts(child.get());
+    } else if(class_def *p = dynamic_cast<class_def *>(n)) {
+        for(auto &child : p->children) res += countByCasts(child.get());
+    } else if(member_access *p = dynamic_cast<member_access *>(n)) {
+        res += countByCasts(p->exp.get());
+        for(auto &arg : p->args) res += countByCasts(arg.get());
+    } else if(pointer_acc *p = dynamic_cast<pointer_acc *>(n)) {
+        res += countByCasts(p->exp.get());
+        for(auto &arg : p->args) res += countByCasts(arg.get());
+    } else if(type_cast *p = dynamic_cast<type_cast *>(n)) {
+        res += countByCasts(p->exp.get());
+    }
+    return res;
+}
+
+double seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t functions = argc > 1 ? std::stoul(argv[1]) : 4096;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    std::string code = generateProgram(functions);
+    sourceFile file("generated.sy", code);
+    nullBuffer null;
+    std::streambuf *console = std::cout.rdbuf(&null);
+
+    size_t visited = 0, cast = 0, nodes = 0;
+    double visitTime = 1e30, castTime = 1e30, checkTime = 1e30;
+    bool typeErrors = false;
+    for(size_t r = 0; r < rounds; r++) {
+        astArena arena;
+        astArena::scope useArena(arena);
+        tokenSource source(file);
+        parseResult result = Parse(source, builtinLRTable());
+        if(result.node == nullptr) {
+            std::cout.rdbuf(console);
+            std::cout << "the generated program does not parse\n";
+            return 1;
+        }
+        program *root = static_cast<program *>(result.node->ptr.get());
+
+        countVisitor counter;
+        auto begin = std::chrono::steady_clock::now();
+        visited = counter.count(root);
+        visitTime = std::min(visitTime, seconds(begin));
+        begin = std::chrono::steady_clock::now();
+        cast = countByCasts(root);
+        castTime = std::min(castTime, seconds(begin));
+
+        TypeChecker checker;
+        checker.setSource(file);
+        begin = std::chrono::steady_clock::now();
+        checker.analyze(root);
+        checkTime = std::min(checkTime, seconds(begin));
+        typeErrors = checker.hasTypeError();
+        nodes = visited;
+    }
+    std::cout.rdbuf(console);
+    if(visited != cast) {
+        std::cout << "the passes disagree (" << visited << ", " << cast << " nodes)\n";
+        return 1;
+    }
+    if(typeErrors) {
+        std::cout << "the generated program does not type check\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "input:         " << functions << " functions, " << nodes << " nodes\n"
+              << "ASTVisitor:    " << std::setw(9) << visitTime * 1e3 << " ms, "
+              << visitTime * 1e9 / nodes << " ns/node\n"
+              << "dynamic_cast:  " << std::setw(9) << castTime * 1e3 << " ms, "
+              << castTime * 1e9 / nodes << " ns/node\n"
+              << "TypeChecker:   " << std::setw(9) << checkTime * 1e3 << " ms, "
+              << checkTime * 1e9 / nodes << " ns/node\n";
+    return 0;
+}
@@ -22,17 +22,17 @@ To use GEP instruction for pointer arithmic, the type field should be set to the
 accessing, the type should be the type of the array itself so that the subarray can be extracted.
 */
 codeGenInfo codeGen::analyzeAdd(binary_expr *node) {
-    auto info1 = node->left->dispatch(this);
-    auto info2 = node->right->dispatch(this);
+    auto info1 = dispatch(node->left);
+    auto info2 = dispatch(node->right);
     llvm::Value *result;
     llvm::outs() << *info1.value << "\n";
     if(node->left->inferred_type->kind == TypeKind::Int && node->left->inferred_type->kind == TypeKind::Int) {
-        if(node->op == "+") result = builder->CreateAdd(info1.value, info2.value);
-        if(node->op == "-") result = builder->CreateSub(info1.value, info2.value);
+        if(node->op == Op_Add) result = builder->CreateAdd(info1.value, info2.value);
+        if(node->op == Op_Sub) result = builder->CreateSub(info1.value, info2.value);
     } else if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Int) {
         llvm::outs() << *info1.value << "\n";
         result = builder->CreateInBoundsGEP(to_llvm_type(node->left->inferred_type)->getPointerElementType(), info1.value, info2.value);
-    } else if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer && node->op == "-") {
+    } else if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer && node->op == Op_Sub) {
         // builder->CreatePtrDiff(to_llvm_type(node->left->inferred_type) , info1.value, info2.value);
     }
     return codeGenInfo{
@@ -41,12 +41,12 @@ codeGenInfo codeGen::analyzeAdd(binary_expr *node) {
 }
 
 codeGenInfo codeGen::analyzeMul(binary_expr *node) {
-    auto info1 = node->left->dispatch(this);
-    auto info2 = node->right->dispatch(this);
+    auto info1 = dispatch(node->left);
+    auto info2 = dispatch(node->right);
     llvm::Value *result;
     if(node->left->inferred_type->kind == TypeKind::Int && node->right->inferred_type->kind == TypeKind::Int) {
-        if(node->op == "*") result = builder->CreateMul(info1.value, info2.value);
-        if(node->op == "/") result = builder->CreateSDiv(info1.value, info2.value);
+        if(node->op == Op_Mul) result = builder->CreateMul(info1.value, info2.value);
+        if(node->op == Op_Div) result = builder->CreateSDiv(info1.value, info2.value);
     }
     return codeGenInfo{
         .value = result
@@ -54,16 +54,16 @@ codeGenInfo codeGen::analyzeMul(binary_expr *node) {
 }
 
 codeGenInfo codeGen::analyzeCompare(binary_expr *node) {
-    auto info1 = node->left->dispatch(this);
-    auto info2 = node->right->dispatch(this);
+    auto info1 = dispatch(node->left);
+    auto info2 = dispatch(node->right);
     llvm::Value *result;
     if(node->left->inferred_type->kind == TypeKind::Int && node->right->inferred_type->kind == TypeKind::Int) {
-        if(node->op == ">") result = builder->CreateICmpSGT(info1.value, info2.value);
-        if(node->op == "<") result = builder->CreateICmpSLT(info1.value, info2.value);
+        if(node->op == Op_Gt) result = builder->CreateICmpSGT(info1.value, info2.value);
+        if(node->op == Op_Lt) result = builder->CreateICmpSLT(info1.value, info2.value);
     }
     if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer) {
-        if(node->op == ">") result = builder->CreateICmpUGT(info1.value, info2.value);
-        if(node->op == "<") result = builder->CreateICmpULT(info1.value, info2.value);
+        if(node->op == Op_Gt) result = builder->CreateICmpUGT(info1.value, info2.value);
+        if(node->op == Op_Lt) result = builder->CreateICmpULT(info1.value, info2.value);
     }
     return codeGenInfo{
         .value = result
@@ -71,16 +71,16 @@ codeGenInfo codeGen::analyzeCompare(binary_expr *node) {
 }
 
 codeGenInfo codeGen::analyzeEq(binary_expr *node) {
-    auto info1 = node->left->dispatch(this);
-    auto info2 = node->right->dispatch(this);
+    auto info1 = dispatch(node->left);
+    auto info2 = dispatch(node->right);
     llvm::Value *result;
     if(node->left->inferred_type->kind == TypeKind::Int && node->right->inferred_type->kind == TypeKind::Int) {
-        if(node->op == "==") result = builder->CreateICmpEQ(info1.value, info2.value);
-        if(node->op == "!=") result = builder->CreateICmpNE(info1.value, info2.value);
+        if(node->op == Op_Eq) result = builder->CreateICmpEQ(info1.value, info2.value);
+        if(node->op == Op_Ne) result = builder->CreateICmpNE(info1.value, info2.value);
     }
     if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer) {
-        if(node->op == "==") result = builder->CreateICmpEQ(info1.value, info2.value);
-        if(node->op == "!=") result = builder->CreateICmpNE(info1.value, info2.value);
+        if(node->op == Op_Eq) result = builder->CreateICmpEQ(info1.value, info2.value);
+        if(node->op == Op_Ne) result = builder->CreateICmpNE(info1.value, info2.value);
     }
     return codeGenInfo{
         .value = result
@@ -88,45 +88,76 @@ codeGenInfo codeGen::analyzeEq(binary_expr *node) {
 }
 
 codeGenInfo codeGen::analyzeGt(binary_expr *node) {
-    auto info1 = node->left->dispatch(this);
-    auto info2 = node->right->dispatch(this);
+    auto info1 = dispatch(node->left);
+    auto info2 = dispatch(node->right);
     llvm::Value *result;
     if(node->left->inferred_type->kind == TypeKind::Int && node->right->inferred_type->kind == TypeKind::Int) {
-        if(node->op == ">=") result = builder->CreateICmpUGT(info1.value, info2.value);
-        if(node->op == "<=") result = builder->CreateICmpULT(info1.value, info2.value);
+        if(node->op == Op_Ge) result = builder->CreateICmpUGT(info1.value, info2.value);
+        if(node->op == Op_Le) result = builder->CreateICmpULT(info1.value, info2.value);
     }
     if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer) {
-        if(node->op == ">=") result = builder->CreateICmpUGT(info1.value, info2.value);
-        if(node->op == "<=") result = builder->CreateICmpULT(info1.value, info2.value);
+        if(node->op == Op_Ge) result = builder->CreateICmpUGT(info1.value, info2.value);
+        if(node->op == Op_Le) result = builder->CreateICmpULT(info1.value, info2.value);
     }
     return codeGenInfo{
         .value = result
     };
 }
 
+const codeGen::binaryGen codeGen::binaryGens[Op_Count] = {
+    /* Op_Add */       &codeGen::analyzeAdd,
+    /* Op_Sub */       &codeGen::analyzeAdd,
+    /* Op_Mul */       &codeGen::analyzeMul,
+    /* Op_Div */       &codeGen::analyzeMul,
+    /* Op_Mod */       nullptr,
+    /* Op_Eq */        &codeGen::analyzeEq,
+    /* Op_Ne */        &codeGen::analyzeEq,
+    /* Op_Lt */        &codeGen::analyzeCompare,
+    /* Op_Gt */        &codeGen::analyzeCompare,
+    /* Op_Le */        &codeGen::analyzeGt,
+    /* Op_Ge */        &codeGen::analyzeGt,
+    /* Op_And */       nullptr, // analyzeLogicAnd
+    /* Op_Or */        nullptr,
+    /* Op_Not */       nullptr,
+    /* Op_BitAnd */    nullptr, // analyzeBitAnd
+    /* Op_BitOr */     nullptr,
+    /* Op_BitXor */    nullptr,
+    /* Op_Shl */       nullptr,
+    /* Op_Shr */       nullptr,
+    /* Op_Assign */    nullptr,
+    /* Op_AddAssign */ nullptr,
+    /* Op_SubAssign */ nullptr,
+    /* Op_MulAssign */ nullptr,
+    /* Op_DivAssign */ nullptr,
+    /* Op_ModAssign */ nullptr,
+    /* Op_Inc */       nullptr,
+    /* Op_Dec */       nullptr
+};
+
+llvm::Constant *codeGen::foldedConstant(expr *node) {
+    if(!node->const_evaluated || !node->constant.is_const) return nullptr;
+    const constValue &value = node->constant.value;
+    switch(value.kind) {
+        case Const_Char: return builder->getInt8(value.c);
+        case Const_Float: return llvm::ConstantFP::get(builder->getFloatTy(), value.f);
+        case Const_Bool: return builder->getInt1(value.b);
+        default: return builder->getInt32(value.i);
+    }
+}
+
 // Expression nodes
 codeGenInfo codeGen::analyze(binary_expr* node) {
-    if(node->op == "+" || node->op == "-") {
-        return analyzeAdd(node);
-    }
-    if(node->op == "*" || node->op == "/") {
-        return analyzeMul(node);
-    }
-    if(node->op == "&" || node->op == "|") {
-        // analyzeBitAnd(node);
-    }
-    if(node->op == "&&" || node->op == "||") {
-        // analyzeLogicAnd(node);
-    }
-    if(node->op == ">" || node->op == "<") {
-        return analyzeCompare(node);
-    }
-    if(node->op == "==" || node->op == "!=") {
-        return analyzeEq(node);
+    if(llvm::Constant *value = foldedConstant(node)) {
+        return codeGenInfo{
+            .value = value
+        };
     }
-    if(node->op == "<=" || node->op == ">=") {
-        return analyzeGt(node);
+    if(binaryGens[node->op] == nullptr) {
+        return codeGenInfo{
+            .value = nullptr
+        };
     }
+    return (this->*binaryGens[node->op])(node);
 }
 
 /*
@@ -134,7 +165,7 @@ Analyze the expression *p, where p could be a pointer to something, or to an arr
 If p points to an array, then dereferencing it
 */
 codeGenInfo codeGen::analyzePointDeref(unary_expr *node) {
-    auto value = node->operand->dispatch(this).value;
+    auto value = dispatch(node->operand).value;
     PointerType *pointer = dynamic_cast<PointerType*>(node->operand->inferred_type);
     if(pointer->elementType->kind == TypeKind::Array) {
         llvm::outs() << *value << "\n";
@@ -152,12 +183,12 @@ codeGenInfo codeGen::analyzePointDeref(unary_expr *node) {
 }
 
 codeGenInfo codeGen::analyzeSimpleUnary(unary_expr *node) {
-    auto value = node->operand->dispatch(this).value;
-    if(node->op == "-") {
+    auto value = dispatch(node->operand).value;
+    if(node->op == Op_Sub) {
         if(node->inferred_type->kind == TypeKind::Int) {
             value = builder->CreateSub(builder->getInt32(0), value);
         }
-    } else if(node->op == "!") {
+    } else if(node->op == Op_Not) {
         if(node->inferred_type->kind == TypeKind::Int) {
             value = builder->CreateZExt(
                 builder->CreateICmpEQ(value, builder->getInt32(0)),
@@ -172,7 +203,12 @@ codeGenInfo codeGen::analyzeSimpleUnary(unary_expr *node) {
 }
 
 codeGenInfo codeGen::analyze(unary_expr* node) {
-    if(node->op == "*") {
+    if(llvm::Constant *value = foldedConstant(node)) {
+        return codeGenInfo{
+            .value = value
+        };
+    }
+    if(node->op == Op_Mul) {
         return analyzePointDeref(node);      
     } else {
         return analyzeSimpleUnary(node);
@@ -182,7 +218,7 @@ codeGenInfo codeGen::analyze(unary_expr* node) {
 //types except arrayType will generate load
 codeGenInfo codeGen::analyze(identifier* node) {
     if(node->inferred_type->kind == TypeKind::Pointer) {
-        auto info = cur->lookup(node->name);
+        auto info = cur->lookup(node->sym);
         auto localVar = llvm::dyn_cast<llvm::AllocaInst>(info.value);
         auto value = builder->CreateLoad(localVar->getAllocatedType(), localVar, node->name);
         // llvm::outs() << *value << "\n";
@@ -190,12 +226,12 @@ codeGenInfo codeGen::analyze(identifier* node) {
             info.value = value
         };
     } else if(node->inferred_type->kind == TypeKind::Array) {
-        auto info = cur->lookup(node->name);
+        auto info = cur->lookup(node->sym);
         return codeGenInfo{.value = info.value};
     } else if(node->inferred_type->kind == TypeKind::ClassVar){
 
     } else { //primitives
-        auto info = cur->lookup(node->name);
+        auto info = cur->lookup(node->sym);
         auto localVar = llvm::dyn_cast<llvm::AllocaInst>(info.value);
         auto value = builder->CreateLoad(localVar->getAllocatedType(), localVar, node->name);
         return codeGenInfo{
@@ -210,8 +246,8 @@ codeGenInfo codeGen::analyze(subscript_expr *node) {
     auto base_type = to_llvm_type(node->base_type);
     llvm::Type *valueType = nullptr;
     llvm::Value *value = nullptr;
-    auto info1 = node->list->dispatch(this);
-    auto info2 = node->sub->dispatch(this);
+    auto info1 = dispatch(node->list);
+    auto info2 = dispatch(node->sub);
     if(node->base_type->kind == TypeKind::Array) { // distinguish array and pointer to array to enable inbound check of the array
         value = builder->CreateInBoundsGEP(base_type, info1.value, {builder->getInt32(0) , info2.value});
         valueType = base_type->getArrayElementType();
@@ -234,14 +270,14 @@ codeGenInfo codeGen::analyze(subscript_expr *node) {
 codeGenInfo codeGen::analyze(fun_call* node) {
     std::vector<llvm::Value*> args;
     for (auto& arg : node->args) {
-        auto argVal = arg->dispatch(this).value;
+        auto argVal = dispatch(arg).value;
         args.push_back(argVal);
     }
-    if(!global->isInCurEnv(node->func_name)) {
+    if(!global->isInCurEnv(node->func_sym)) {
         std::cout << "codeGen fun_call analyze fail\n";
         exit(1);
     }
-    auto fn = llvm::dyn_cast<llvm::Function>(global->lookup(node->func_name).value);
+    auto fn = llvm::dyn_cast<llvm::Function>(global->lookup(node->func_sym).value);
     if(!fn) {
         std::cout << "codeGen fun_call analyze fail\n";
         exit(1);
@@ -258,7 +294,7 @@ Handling typecasting.
 2. Int -> Float
 */
 codeGenInfo codeGen::analyze(type_cast *node) {
-    auto value = node->exp->dispatch(this).value;
+    auto value = dispatch(node->exp).value;
     if(node->exp->inferred_type->kind == TypeKind::Array && node->target->kind == TypeKind::Pointer) { //pointer decay
         value = builder->CreateInBoundsGEP(to_llvm_type(node->exp->inferred_type), value, {builder->getInt32(0), builder->getInt32(0)});
         llvm::outs() << *value << *to_llvm_type(node->exp->inferred_type) << "\n";
@@ -277,12 +313,12 @@ codeGenInfo codeGen::analyze(int_literal* node) {
 
 // Statement nodes
 codeGenInfo codeGen::analyze(expr_stmt* node) {
-    node->ptr->dispatch(this);
+    dispatch(node->ptr);
     return codeGenInfo();
 }
 
 codeGenInfo codeGen::analyze(if_else_stmt* node) {
-    auto cond = node->cond->dispatch(this).value;
+    auto cond = dispatch(node->cond).value;
 
     llvm::BasicBlock *ThenBB = llvm::BasicBlock::Create(*ctx, "then", currentFn);
     llvm::BasicBlock *ElseBB = llvm::BasicBlock::Create(*ctx, "else", currentFn);
@@ -298,7 +334,7 @@ codeGenInfo codeGen::analyze(if_else_stmt* node) {
     }
 
     builder->SetInsertPoint(ThenBB);
-    node->if_branch->dispatch(this);
+    dispatch(node->if_branch);
     if(node->else_branch) {
         terminateBlockWithBr(MeetBB, builder.get());
     } else {
@@ -307,7 +343,7 @@ codeGenInfo codeGen::analyze(if_else_stmt* node) {
 
     if(node->else_branch) {
         builder->SetInsertPoint(ElseBB);
-        node->else_branch->dispatch(this);
+        dispatch(node->else_branch);
         terminateBlockWithBr(MeetBB, builder.get());
         currentFn->getBasicBlockList().push_back(MeetBB);
         builder->SetInsertPoint(MeetBB);
@@ -339,7 +375,7 @@ codeGenInfo codeGen::analyze(while_stmt* node) {
     curLoopStart = llvm::BasicBlock::Create(*ctx, "loop_start", currentFn);
     terminateBlockWithBr(curLoopStart, builder.get());
     builder->SetInsertPoint(curLoopStart);
-    auto cond = node->cond->dispatch(this).value;
+    auto cond = dispatch(node->cond).value;
     llvm::BasicBlock *LoopBody = llvm::BasicBlock::Create(*ctx, "loop_body", currentFn);
 
     curLoopEnd = llvm::BasicBlock::Create(*ctx, "loop_end", currentFn);
@@ -348,7 +384,7 @@ codeGenInfo codeGen::analyze(while_stmt* node) {
         builder->CreateCondBr(cond, LoopBody, curLoopEnd);
     }
     builder->SetInsertPoint(LoopBody);
-    node->body->dispatch(this);
+    dispatch(node->body);
     terminateBlockWithBr(curLoopStart, builder.get());
     builder->SetInsertPoint(curLoopEnd);
 
@@ -377,7 +413,7 @@ codeGenInfo codeGen::analyze(continue_stmt* node) {
 }
 
 codeGenInfo codeGen::analyze(return_stmt* node) {
-    auto info = node->value->dispatch(this);
+    auto info = dispatch(node->value);
     builder->CreateRet(info.value);
     return codeGenInfo();
 }
@@ -387,7 +423,7 @@ codeGenInfo codeGen::analyze(block_stmt* node) {
     cur = new environment(cur);
 
     for(size_t i = 0; i < node->items.size(); i++) {
-        node->items[i]->dispatch(this);
+        dispatch(node->items[i]);
     }
 
     delete cur;
@@ -423,13 +459,13 @@ codeGenInfo codeGen::analyze(func_def* node) {
     auto fn = node->type;
     auto fnType = static_cast<llvm::FunctionType*>(to_llvm_type(node->type));
     currentFn = llvm::Function::Create(fnType, llvm::Function::ExternalLinkage, node->name, *module);
-    global->insert(node->name, 
+    global->insert(node->sym, 
     env_info{
         .value = currentFn
     });
     size_t argIdx = 0;
     for(auto it = currentFn->arg_begin(); it != currentFn->arg_end(); it++) {
-        it->setName(fn->bindings[argIdx]);
+        it->setName(std::string(Interner::spelling(fn->bindings[argIdx])));
         argIdx++;
     }
 
@@ -452,14 +488,14 @@ codeGenInfo codeGen::analyze(func_def* node) {
     }
 
     for(size_t i = 0; i < node->body.size(); i++) {
-        node->body[i]->dispatch(this);
+        dispatch(node->body[i]);
     }
     auto value = builder->CreateAdd(builder->getInt32(1), builder->getInt32(2));
 
     delete cur;
     cur = oldtable;
 
-    currentFn->viewCFG(); 
+    if(viewCFG) currentFn->viewCFG();
 
     llvm::verifyFunction(*currentFn);
     return codeGenInfo();
@@ -472,7 +508,7 @@ codeGenInfo codeGen::analyze(var_def* node) {
     if(node->init_val) {
         init_val *val = dynamic_cast<init_val*>(node->init_val.get());
         if(val->scalar) {
-            auto scalar = val->scalar->dispatch(this).value;
+            auto scalar = dispatch(val->scalar).value;
             builder->CreateStore(scalar, addr);
         } else if(val->children.size() > 0) {
             if(node->type->kind != TypeKind::Array) {
@@ -487,7 +523,7 @@ codeGenInfo codeGen::analyze(var_def* node) {
                     array_base = builder->CreateInBoundsGEP(array_base->getType()->getPointerElementType(), array_base, {builder->getInt32(0), builder->getInt32(0)});
                 }
                 for(size_t i = 0; i < val->children.size(); i++) {
-                    auto llvm_elem_var = val->children[i]->scalar->dispatch(this).value;
+                    auto llvm_elem_var = dispatch(val->children[i]->scalar).value;
                     builder->CreateStore(llvm_elem_var, array_base);
                     array_base = builder->CreateInBoundsGEP(array_base->getType()->getPointerElementType(), array_base, builder->getInt32(1)); 
                 }
@@ -498,7 +534,7 @@ codeGenInfo codeGen::analyze(var_def* node) {
         }
     }
     // module->print(llvm::outs(), nullptr);
-    cur->insert(node->id, env_info{
+    cur->insert(node->sym, env_info{
         addr
     });
     return codeGenInfo();
@@ -506,7 +542,7 @@ codeGenInfo codeGen::analyze(var_def* node) {
 
 codeGenInfo codeGen::analyze(var_decl* node) {
     for(size_t i = 0; i < node->defs.size(); i++) {
-        node->defs[i]->dispatch(this);
+        dispatch(node->defs[i]);
     }
     return codeGenInfo();
 }
@@ -514,7 +550,7 @@ codeGenInfo codeGen::analyze(var_decl* node) {
 // Program node
 codeGenInfo codeGen::analyze(program* node) {
     for(size_t i = 0; i < node->children.size(); i++) {
-        node->children[i]->dispatch(this);
+        dispatch(node->children[i]);
     }
 
     bool hasErrors = llvm::verifyModule(*module, &llvm::errs());
@@ -613,18 +649,18 @@ environment::environment()
     parent = nullptr;
 }
 
-void environment::insert(std::string name, env_info info)
+void environment::insert(symId name, env_info info)
 {
     mapping[name] = info;
 }
 
-env_info environment::lookup(std::string name)
+env_info environment::lookup(symId name)
 {
     if(mapping.find(name) == mapping.end()) {
         if(parent) {
             return parent->lookup(name);
         } else {
-            std::cout << "symbol " + name + " cannot be found in the environment\n";
+            std::cout << "symbol " << Interner::spelling(name) << " cannot be found in the environment\n";
             exit(1);
         }
     } else {
@@ -632,7 +668,7 @@ env_info environment::lookup(std::string name)
     }
 }
 
-bool environment::isExist(std::string name)
+bool environment::isExist(symId name)
 {
     if(mapping.find(name) != mapping.end()) {
         return true;
@@ -645,7 +681,7 @@ bool environment::isExist(std::string name)
     return false;
 }
 
-bool environment::isInCurEnv(std::string name)
+bool environment::isInCurEnv(symId name)
 {
     return mapping.find(name) != mapping.end();
 }
@@ -2,6 +2,8 @@
 #define __CODE_GEN_H
 
 #include "common/common.hpp"
+#include "lexer/interner.hpp"
+#include "parser/astnodes/astVisitor.hpp"
 
 #include "llvm-14/llvm/IR/Module.h"
 #include "llvm-14/llvm/IR/LLVMContext.h"
@@ -52,10 +54,13 @@ struct codeGenInfo {
     llvm::Value *value;
 };
 
-struct codeGen {
+struct codeGen : ASTVisitor<codeGen, codeGenInfo> {
     codeGen();
 
     void setOutputFileName(const std::string &name);
+    // Whether the CFG of every function is written to a .dot file in /tmp and opened in a
+    // graph viewer (llvm::Function::viewCFG) once it is generated. On by default.
+    void setViewCFG(bool view) { viewCFG = view; }
 
     codeGenInfo analyze(class_def* node) ;
 
@@ -90,6 +95,11 @@ struct codeGen {
     codeGenInfo analyze(member_access *node);
     codeGenInfo analyze(pointer_acc *node);
 
+    // Called by dispatch. Initializers are emitted by their var_def.
+    template <typename Node>
+    codeGenInfo visit(Node *node) { return analyze(node); }
+    codeGenInfo visit(init_val *) { return codeGenInfo(); }
+
     // void analyzeFunctionBody(func_def *node);
     // void analyzeInit(var_def* node);
 private:
@@ -106,6 +116,11 @@ private:
     codeGenInfo analyzeGt(binary_expr *node);
     codeGenInfo analyzePointDeref(unary_expr *node);
     codeGenInfo analyzeSimpleUnary(unary_expr *node);
+    // The constant the checker folded the expression to, or nullptr.
+    llvm::Constant *foldedConstant(expr *node);
+    // The code generator of each binary operator, by OpKind, or nullptr if there is none.
+    using binaryGen = codeGenInfo (codeGen::*)(binary_expr *);
+    static const binaryGen binaryGens[];
     // codeGenInfo analyzeNot()
     /*
         If the block has no terminating instruction, then set it to point to the target basic block.
@@ -124,6 +139,7 @@ private:
     llvm::BasicBlock *curLoopStart;
     llvm::BasicBlock *curLoopEnd;
     std::string outFileName;
+    bool viewCFG = true;
 
     environment *cur;
     environment *global;
@@ -137,12 +153,12 @@ struct environment {
     environment(struct environment *parent);
     environment();
     struct environment *parent;
-    std::map<std::string, env_info> mapping;
+    std::unordered_map<symId, env_info> mapping; // keyed by interned name
 
-    void insert(std::string name, env_info info);
-    env_info lookup(std::string name);
-    bool isExist(std::string name);
-    bool isInCurEnv(std::string name);
+    void insert(symId name, env_info info);
+    env_info lookup(symId name);
+    bool isExist(symId name);
+    bool isInCurEnv(symId name);
 };
 
 using envPtr = std::shared_ptr<environment>;
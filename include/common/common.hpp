@@ -11,6 +11,8 @@
 #include<queue>
 #include<algorithm>
 #include<string>
+#include<string_view>
+#include<memory>
 #include <iomanip>
 #include <sstream>
 #include <cassert>
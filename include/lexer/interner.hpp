@@ -0,0 +1,39 @@
+#ifndef __INTERNER_H
+#define __INTERNER_H
+
+#include <atomic>
+#include <mutex>
+#include "common/common.hpp"
+
+// Dense id of an interned identifier. 0 is the empty string, i.e. "no name".
+using symId = uint32_t;
+
+/*
+    Process-wide identifier interner. The parser interns every ID token once as it is
+    shifted, and the symbol table and the codegen environments are keyed on the id, so
+    resolving a name is an integer hash instead of a string compare. Spellings are stored
+    in chunks that double in size and are never moved or freed, so the views handed out
+    stay valid for the whole run. Parallel lexing and checking may intern concurrently:
+    intern takes a lock and publishes the new count, and spelling only reads the count,
+    so looking a name up never waits on the lock.
+*/
+struct Interner {
+    public:
+        static symId intern(std::string_view str);
+        static std::string_view spelling(symId id);
+
+    private:
+        // chunk k holds firstChunk << k spellings, so 32 chunks cover every symId
+        static constexpr size_t firstChunk = 1024;
+        static constexpr size_t chunkCount = 32;
+        static size_t chunkOf(size_t id);
+        static std::string &slot(size_t id);
+
+    private:
+        static std::mutex lock;
+        static std::string *chunks[chunkCount];
+        static std::atomic<size_t> count; // spellings written, released by intern
+        static std::unordered_map<std::string_view, symId> ids;
+};
+
+#endif
@@ -2,18 +2,62 @@
 #define __LEXER_H
 
 #include "lexer/token.hpp"
+#include "lexer/sourceManager.hpp"
 
+/*
+    The token stream is kept as parallel arrays of kinds, byte offsets and lengths that
+    point into the text of a sourceFile, which has to outlive the stream. Rows and
+    columns are not stored per token; the sourceFile recovers them from the offsets.
+*/
 struct lexInfo
 {
-    std::vector<token> tokens;
-    std::vector<std::string> rows;
+    const sourceFile *file = nullptr;
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+
+    size_t size() const { return kinds.size(); }
+    token::tokenType kind(size_t i) const { return token::tokenType(kinds[i]); }
+    std::string_view text(size_t i) const { return file->text.substr(offsets[i], lengths[i]); }
+    std::pair<size_t, size_t> location(size_t i) const { return file->locate(offsets[i]); }
+    token at(size_t i) const { return token(kind(i), text(i), location(i)); }
+};
+
+/*
+    Pull-based scanner over a sourceFile. Every call to next() runs the DFA over the input
+    up to and including exactly one token, skipping whitespace and comments on the way,
+    and leaves that token in kind/offset/length. Nothing else of the input is buffered.
+*/
+struct tokenSource {
+    public:
+        tokenSource(const sourceFile &file)
+        : file(&file), pos(0), limit(file.text.size()) {}
+        // Scans only [begin, end) of the file, which must start and end on token boundaries.
+        tokenSource(const sourceFile &file, size_t begin, size_t end)
+        : file(&file), pos(begin), limit(end) {}
+
+        // Scans the next token; returns false once the input is exhausted.
+        bool next();
+        std::string_view text() const { return file->text.substr(offset, length); }
+        std::pair<size_t, size_t> location() const { return file->locate(offset); }
+
+    public:
+        const sourceFile *file;
+        token::tokenType kind = token::END_OF_FILE;
+        uint32_t offset = 0;
+        uint32_t length = 0;
+
+    private:
+        size_t pos;
+        size_t limit;
 };
 
 
 std::string token_serialize(const token &token);
-lexInfo tokenize(const std::string &code);
-std::string readSrc(std::string path);
-void printTokens(const std::vector<token> &tokens);
+// Files of several MB are split into chunks that are lexed on `threads` threads
+// (0 means one per hardware thread). The result is the same as lexing serially.
+lexInfo tokenize(const sourceFile &file, size_t threads = 0);
+std::vector<size_t> findChunkBoundaries(std::string_view code, size_t chunks);
+void printTokens(const lexInfo &tokens);
 
 #endif
-
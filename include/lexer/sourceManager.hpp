@@ -0,0 +1,56 @@
+#ifndef __SOURCE_MANAGER_H
+#define __SOURCE_MANAGER_H
+
+#include <mutex>
+#include "common/common.hpp"
+
+/*
+    A read-only view of one input file. The index of line starts is only built the first
+    time a location or a line is asked for, which for a well-formed program is never.
+*/
+struct sourceFile {
+    public:
+        sourceFile(std::string path, std::string_view text)
+        : path(std::move(path)), text(text) {}
+
+        // 1-based (row, column) of a byte offset
+        std::pair<size_t, size_t> locate(size_t offset) const;
+        size_t lineCount() const { return lineStarts().size(); }
+        // the text of a 1-based row, including its '\n' if it has one
+        std::string_view line(size_t row) const;
+
+    public:
+        std::string path;
+        std::string_view text;
+
+    private:
+        const std::vector<uint32_t> &lineStarts() const;
+        mutable std::vector<uint32_t> starts;
+        mutable std::once_flag indexed;
+};
+
+/*
+    Owns every input file of a compile. Files are mapped read-only with mmap, so the
+    lexer, the parser and the diagnostics all look at the same pages and no copy of the
+    text is ever made. Everything handed out stays valid until the manager is destroyed.
+*/
+struct SourceManager {
+    public:
+        SourceManager() = default;
+        SourceManager(const SourceManager &) = delete;
+        SourceManager &operator=(const SourceManager &) = delete;
+        ~SourceManager();
+
+        // Maps the file at path; a file that cannot be opened is a fatal error.
+        const sourceFile &load(const std::string &path);
+
+    private:
+        struct mapping {
+            void *addr;
+            size_t size;
+        };
+        std::vector<std::unique_ptr<sourceFile>> files;
+        std::vector<mapping> mappings;
+};
+
+#endif
@@ -45,12 +45,13 @@ struct token {
         END_OF_FILE, INVALID
     };
     
-    std::string value;
+    // A decoded view of one entry of a lexInfo; the text points into the source buffer.
+    std::string_view value;
     tokenType type;
     std::pair<size_t, size_t> location;
 
-    token(tokenType type, std::string value, size_t x, size_t y)
-        :value(value), type(type), location({x, y}) {}
+    token(tokenType type, std::string_view value, std::pair<size_t, size_t> location)
+        :value(value), type(type), location(location) {}
 };
 
 #endif
\ No newline at end of file
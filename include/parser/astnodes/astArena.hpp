@@ -0,0 +1,88 @@
+#ifndef __AST_ARENA_H
+#define __AST_ARENA_H
+
+#include <cstddef>
+#include "common/common.hpp"
+
+/*
+    Bump-pointer storage for the AST of one compilation unit. Every node is allocated
+    from the arena installed on the current thread (see astArena::scope), and deleting a
+    node only runs its destructor: the memory of all nodes is returned at once, block by
+    block, when the arena is destroyed. Nodes must therefore not outlive their arena.
+
+    Without an installed arena, nodes go to a per-thread fallback arena that lives until
+    the program exits.
+*/
+struct astArena {
+    public:
+        astArena() = default;
+        astArena(const astArena &) = delete;
+        astArena &operator=(const astArena &) = delete;
+        ~astArena();
+
+        void *allocate(size_t size) {
+            size = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+            if(size > size_t(end - cur)) grow(size);
+            void *p = cur;
+            cur += size;
+            used += size;
+            return p;
+        }
+        size_t bytesUsed() const { return used; }
+        size_t blockCount() const { return blocks.size(); }
+        // Takes over the blocks of other, so that its nodes live as long as this arena.
+        void adopt(astArena &other);
+
+        // The arena new nodes are allocated from on this thread.
+        static astArena &current();
+
+        // Installs an arena on this thread for the lifetime of the object.
+        struct scope {
+            public:
+                scope(astArena &arena);
+                scope(const scope &) = delete;
+                scope &operator=(const scope &) = delete;
+                ~scope();
+            private:
+                astArena *previous;
+        };
+
+    private:
+        void grow(size_t size);
+
+    private:
+        static constexpr size_t blockSize = 64 * 1024;
+        std::vector<char *> blocks;
+        char *cur = nullptr, *end = nullptr;
+        size_t used = 0;
+};
+
+/*
+    A free list of fixed-size slots for short-lived objects of one type, such as the
+    parseInfo records on the parser stack: freed slots are reused by the next allocation
+    on the same thread, so steady-state parsing does not call the allocator.
+*/
+template <size_t Size>
+struct slotPool {
+    public:
+        static void *allocate() {
+            if(freeList == nullptr) return ::operator new(Size);
+            slot *s = freeList;
+            freeList = s->next;
+            return s;
+        }
+        static void release(void *p) {
+            slot *s = (slot *)p;
+            s->next = freeList;
+            freeList = s;
+        }
+
+    private:
+        struct slot {
+            slot *next;
+        };
+        static_assert(Size >= sizeof(slot), "slot too small for the free list");
+        static inline thread_local slot *freeList = nullptr;
+};
+
+#endif
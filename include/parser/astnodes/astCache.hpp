@@ -0,0 +1,69 @@
+#ifndef __AST_CACHE_H
+#define __AST_CACHE_H
+
+#include "parser/astnodes/flatAST.hpp"
+
+/*
+    Cache entry format. An entry is the flatAST of a checked program, written as:
+        astCacheHeader
+        names        count, then each spelling as its length and bytes
+        types        count, then one record per type (see astCache.cpp); 0 is no type
+        nodes        count, then the columns kinds, ops, flags (bytes) and lines,
+                     columns, first, second, third, types (32-bit words)
+        lists        count, then the words of flatAST::lists
+        errors       count, then pairs of handle and message
+        root         the handle of the program
+    Names in the node slots and in the types are indices into `names`, since symIds
+    differ from one run to the next. All fields are native-endian. Bump astCacheVersion
+    on any layout change; an entry is also only used by the compiler build that wrote it.
+*/
+constexpr char astCacheMagic[8] = "HDU-AST";
+constexpr uint32_t astCacheVersion = 2;
+
+struct astCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t buildId;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+};
+
+// FNV-1a of a source text.
+uint64_t sourceHash(std::string_view text);
+// Identifies the running compiler: the cache version, the grammar, and the size and
+// modification time of the executable, which change with every rebuild.
+uint64_t compilerBuildId();
+
+/*
+    An on-disk cache of checked ASTs, so that a source compiled again unchanged goes
+    straight to codegen without tokenize, Parse and TypeChecker::analyze. Entries live in
+    <dir>/ast-<source hash>.bin and are replaced by renaming, like lrTableCache's tables;
+    an entry from another build or for another source of the same hash is a miss and is
+    overwritten by the next store. Programs with class types are not cached.
+
+    Every lookup is also appended to <dir>/ast-stats as one byte, so that printStats can
+    report the hits and misses of all compilations that shared the directory.
+*/
+struct astCache {
+    public:
+        astCache(const std::string &dir);
+
+        // The checked AST of source, rebuilt in the current astArena, or nullptr on a miss.
+        nodePtr load(std::string_view source);
+        // Stores the checked AST of source; returns false if it could not be cached.
+        bool store(std::string_view source, node *root);
+        // The hits and misses of this object and of the whole directory.
+        void printStats(std::ostream &out) const;
+
+        std::string entryPath(std::string_view source) const;
+
+    public:
+        std::string dir;
+        size_t hits = 0, misses = 0, stores = 0, uncacheable = 0;
+
+    private:
+        void record(bool hit);
+};
+
+#endif
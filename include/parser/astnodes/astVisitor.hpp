@@ -0,0 +1,25 @@
+#ifndef __AST_VISITOR_H
+#define __AST_VISITOR_H
+
+#include <memory>
+
+struct node;
+
+/*
+    A pass over the AST that dispatches on node::kind with one switch instead of a
+    virtual call on the node followed by an overload on the pass. Derived provides a
+    visit(T *) returning Ret for every concrete node class; dispatch casts the node to its
+    class and calls the visit for it, which the compiler can inline.
+
+    dispatch is defined at the end of node.hpp, where the node classes are complete, so
+    that this header can be included by the passes that node.hpp itself includes.
+*/
+template <typename Derived, typename Ret>
+struct ASTVisitor {
+    public:
+        Ret dispatch(node *n);
+        template <typename T>
+        Ret dispatch(const std::unique_ptr<T> &n) { return dispatch(n.get()); }
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef __FLAT_AST_H
+#define __FLAT_AST_H
+
+#include "parser/astnodes/node.hpp"
+
+/*
+    A compact form of the AST for large programs. Nodes are rows of parallel columns
+    addressed by 32-bit handles instead of heap objects: a kind byte, an operator byte, a
+    flag byte, the location as two 32-bit words and three 32-bit slots whose meaning
+    depends on the kind (see flatKind). Names are interned symIds, types are indices into
+    a table of the distinct Type pointers, and the variable-length child lists of all
+    nodes share one array in which a list is its length followed by the handles of its
+    elements. Nodes are stored in preorder, so a whole-tree pass is a scan of the columns.
+
+    fromTree and toTree convert from and to the node hierarchy, so passes can move to the
+    flat form one at a time and hand the tree on to the ones that have not.
+*/
+using astHandle = uint32_t;
+constexpr astHandle noNode = 0xffffffff;
+
+// The kinds of flat nodes, with the use of the slots first, second and third. A list is
+// an offset into flatAST::lists.
+enum flatKind : uint8_t {
+    FLAT_PROGRAM,        // list of top-level items
+    FLAT_INT_LITERAL,    // value
+    FLAT_UNARY,          // operand, -, folded value; OpKind, FLAT_FOLDED
+    FLAT_BINARY,         // left, right, folded value; OpKind, FLAT_FOLDED
+    FLAT_SUBSCRIPT,      // list, subscript, base type
+    FLAT_IDENTIFIER,     // name
+    FLAT_EXPR_STMT,      // expression
+    FLAT_IF_ELSE,        // condition, if branch, else branch or noNode
+    FLAT_WHILE,          // condition, body
+    FLAT_BREAK,
+    FLAT_CONTINUE,
+    FLAT_RETURN,         // value or noNode
+    FLAT_BLOCK,          // list of items
+    FLAT_FUN_CALL,       // name, list of arguments
+    FLAT_FUNC_DEF,       // name, list of body items; FLAT_CTOR
+    FLAT_VAR_DEF,        // name, initializer or noNode; FLAT_CONST
+    FLAT_VAR_DECL,       // type name, list of definitions; FLAT_CONST
+    FLAT_INIT_VAL,       // scalar or noNode, list of elements; FLAT_CONST
+    FLAT_CLASS_DEF,      // name, list of members
+    FLAT_MEMBER_ACCESS,  // member name, object, list of arguments; FLAT_METHOD
+    FLAT_POINTER_ACC,    // member name, object pointer, list of arguments; FLAT_METHOD
+    FLAT_TYPE_CAST       // expression, target type; FLAT_IMPLICIT
+};
+
+enum flatFlag : uint8_t {
+    FLAT_CONST = 1,    // const definitions and initializers, and constant expressions
+    FLAT_CTOR = 2,
+    FLAT_METHOD = 4,
+    FLAT_IMPLICIT = 8,
+    FLAT_FOLDED = 16   // an int operation the checker folded to the value in third
+};
+
+// The handles of a child list.
+struct handleList {
+    public:
+        const astHandle *begin() const { return first; }
+        const astHandle *end() const { return first + count; }
+        size_t size() const { return count; }
+        astHandle operator[](size_t i) const { return first[i]; }
+    public:
+        const astHandle *first;
+        uint32_t count;
+};
+
+struct flatAST {
+    public:
+        flatAST();
+
+        // Appends the tree under root and returns its handle.
+        astHandle fromTree(node *root);
+        // Rebuilds the tree under n in the current astArena.
+        nodePtr toTree(astHandle n) const;
+
+        size_t size() const { return kinds.size(); }
+        handleList list(uint32_t offset) const {
+            return handleList{lists.data() + offset + 1, lists[offset]};
+        }
+        std::string_view name(astHandle n) const { return Interner::spelling(first[n]); }
+        struct Type *type(astHandle n) const { return typeTable[types[n]]; }
+        std::pair<size_t, size_t> location(astHandle n) const { return {lines[n], columns[n]}; }
+
+        // Bytes held by the columns, lists and tables.
+        size_t bytes() const;
+        // Releases the spare capacity of the columns once no more nodes are added.
+        void shrinkToFit();
+
+    public:
+        std::vector<flatKind> kinds;
+        std::vector<OpKind> ops;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> lines, columns;
+        std::vector<uint32_t> first, second, third;
+        std::vector<uint32_t> types;              // index into typeTable; 0 is no type
+        std::vector<struct Type *> typeTable;
+        std::vector<uint32_t> lists;
+        std::unordered_map<astHandle, std::string> errors; // the few nodes with an error_msg
+
+    private:
+        astHandle add(flatKind kind, node *from);
+        uint32_t addList(const std::vector<astHandle> &handles);
+        uint32_t typeIndex(struct Type *type);
+        void setType(astHandle n, struct Type *type) { types[n] = typeIndex(type); }
+        void copyCommon(astHandle n, node *to) const;
+        void setFolded(astHandle n, expr *e);
+        void copyFolded(astHandle n, expr *to) const;
+
+    private:
+        std::unordered_map<struct Type *, uint32_t> indexOfType;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define __NODE_H
 
 #include "common/common.hpp"
+#include "parser/astnodes/astArena.hpp"
 
 
 struct node;
@@ -40,10 +41,47 @@ enum ASTKind {
     Var_Decl,
     Init_Val,
     Class_Def,
-    Type_Cast
+    Type_Cast,
+    Subscript_Expr,
+    Block_Stmt,
+    Member_Access,
+    Pointer_Acc
 };
 
 
+// Operators of unary_expr and binary_expr. A unary * is a dereference.
+enum OpKind : uint8_t {
+    Op_Add,
+    Op_Sub,
+    Op_Mul,
+    Op_Div,
+    Op_Mod,
+    Op_Eq,
+    Op_Ne,
+    Op_Lt,
+    Op_Gt,
+    Op_Le,
+    Op_Ge,
+    Op_And,
+    Op_Or,
+    Op_Not,
+    Op_BitAnd,
+    Op_BitOr,
+    Op_BitXor,
+    Op_Shl,
+    Op_Shr,
+    Op_Assign,
+    Op_AddAssign,
+    Op_SubAssign,
+    Op_MulAssign,
+    Op_DivAssign,
+    Op_ModAssign,
+    Op_Inc,
+    Op_Dec,
+    Op_Count
+};
+
+const std::string &opSpelling(OpKind op);
 
 struct typeEvaluator {
     virtual void evaluateType () = 0;
@@ -71,10 +109,11 @@ std::string locToString(std::pair<size_t, size_t> location, std::string tail);
 struct node {
     public:
         node(std::pair<size_t, size_t> loc);
+        // Nodes live in the current astArena; delete only runs the destructor.
+        static void *operator new(size_t size) { return astArena::current().allocate(size); }
+        static void operator delete(void *) {}
         virtual std::string to_string() = 0;
-        virtual void printAST(std::string prefix, std::string info_prefix) = 0;
-        virtual analyzeInfo dispatch(TypeChecker *ptr) = 0;
-        virtual codeGenInfo dispatch(codeGen *ptr) = 0;
+        virtual void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) = 0;
     public:
         ASTKind kind = Node;
         std::pair<size_t, size_t> location;
@@ -85,9 +124,7 @@ struct program : public node{
     public:
         program(std::pair<size_t, size_t> loc);
         std::string to_string() override;
-        void printAST(std::string prefix, std::string info_prefix) override;
-        analyzeInfo dispatch(TypeChecker *ptr) ;
-        codeGenInfo dispatch(codeGen *ptr);
+        void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     public:
         std::vector<node*> children;
 };
@@ -99,29 +136,28 @@ struct expr : public node, public constEvaluator {
         void setConst(bool is_const);
     public:
         struct Type *inferred_type;
-        bool is_const;
+        bool is_const = false;
+        // set by TypeChecker::constEval
+        bool const_evaluated = false;
+        constInfo constant;
 };
 
 struct unary_expr : public expr {
-    unary_expr(std::pair<size_t, size_t> loc, std::string op, expPtr operand);
+    unary_expr(std::pair<size_t, size_t> loc, OpKind op, expPtr operand);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr) ;
-    std::string op;
+    OpKind op;
     expPtr operand;
 };
 
 struct binary_expr : public expr {
-    binary_expr(std::pair<size_t, size_t> loc, std::string op,
+    binary_expr(std::pair<size_t, size_t> loc, OpKind op,
                expPtr left, expPtr right);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr) ;
-    std::string op;
+    OpKind op;
     expPtr left;
     expPtr right;
 };
@@ -129,9 +165,7 @@ struct binary_expr : public expr {
 struct subscript_expr : public expr {
     subscript_expr(std::pair<size_t, size_t> loc, expPtr list, expPtr sub);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr) ;
     struct Type *base_type = nullptr;
     expPtr list = nullptr;
@@ -139,13 +173,12 @@ struct subscript_expr : public expr {
 };
 
 struct identifier : public expr {
-    identifier(std::pair<size_t, size_t> loc, std::string name);
+    identifier(std::pair<size_t, size_t> loc, std::string name, symId sym);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr) ;
     std::string name;
+    symId sym;
 };
 
 // struct lval_expr : public expr {
@@ -171,9 +204,7 @@ struct stmt : public node {
 struct expr_stmt : public stmt {
     expr_stmt(std::pair<size_t, size_t> loc, expPtr ptr);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     expPtr ptr;
 };
 
@@ -181,10 +212,7 @@ struct if_else_stmt : public stmt {
     if_else_stmt(std::pair<size_t, size_t> loc, expPtr cond,
                 stmtPtr if_branch, stmtPtr else_branch = nullptr);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
-    const ASTKind kind = IF_ELSE_Stmt;
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     expPtr cond;
     stmtPtr if_branch;
     stmtPtr else_branch;
@@ -194,9 +222,7 @@ struct while_stmt : public stmt {
     while_stmt(std::pair<size_t, size_t> loc, expPtr cond,
               stmtPtr body);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     expPtr cond;
     stmtPtr body;
 };
@@ -206,27 +232,21 @@ struct break_stmt : public stmt {
 public:
     break_stmt(std::pair<size_t, size_t> loc) ;
     std::string to_string() override ;
-    void printAST(std::string prefix, std::string info_prefix) override ;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override ;
 };
 
 struct continue_stmt : public stmt {
 public:
     continue_stmt(std::pair<size_t, size_t> loc);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
 };
 
 struct return_stmt : public stmt {
 public:
     return_stmt(std::pair<size_t, size_t> loc, expPtr value = nullptr) ;
     std::string to_string() override ;
-    void printAST(std::string prefix, std::string info_prefix) override ;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override ;
 public:
     expPtr value;
 };
@@ -236,9 +256,7 @@ struct block_stmt : public stmt {
     void add_item(nodePtr item);
     void setLoc(std::pair<size_t, size_t> loc);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ; 
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     std::vector<nodePtr> items;
 };
 
@@ -247,7 +265,7 @@ struct block_stmt : public stmt {
 struct literal : public expr {
     public:
         literal(std::pair<size_t, size_t> loc);
-        void printAST(std::string prefix, std::string info_prefix) override;
+        void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
 };
 
 struct bool_literal : public literal {
@@ -258,11 +276,8 @@ struct int_literal : public literal {
     public:
         int_literal(std::pair<size_t, size_t> loc, int val);     
         std::string to_string() override ;
-        analyzeInfo dispatch(TypeChecker *ptr) ;
-        codeGenInfo dispatch(codeGen *ptr);
         constInfo const_eval(TypeChecker *ptr) ;
     public:
-        const ASTKind kind = Int_Literal;
         int value;
 };
 
@@ -275,16 +290,14 @@ struct fun_call : public expr {
 public:
     fun_call(std::pair<size_t, size_t> loc);
     void addParam(expPtr param);
-    void setName(std::string name);
+    void setName(std::string name, symId sym);
     std::string to_string() override ;
     void setLoc(std::pair<size_t, size_t> loc) ;
-    void printAST(std::string prefix, std::string info_prefix) override ;
-    analyzeInfo dispatch(TypeChecker *ptr) override;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override ;
     constInfo const_eval(TypeChecker *ptr) ;
 public:
-    const ASTKind kind = Fun_Call;
     std::string func_name;
+    symId func_sym = 0;
     std::vector<expPtr> args;
 };
 
@@ -293,28 +306,26 @@ struct func_def : public node {
     func_def(std::pair<size_t, size_t> loc);
     void set_body(blockPtr body);
     std::string to_string() override;
-    void printArgList(std::string prefix, std::string info_prefix);
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printArgList(std::string prefix, std::string info_prefix, std::ostream &out = std::cout);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     void setCtor();
     FuncType *type; //will be evaluated during type checking
     std::string name;
+    symId sym = 0;
     std::vector<nodePtr> body;
     bool is_constructor = false;
 };
 
 struct var_def : public node {
     var_def(std::pair<size_t, size_t> loc);
-    void setId(const std::string& name);
+    void setId(const std::string& name, symId sym);
     void setConst(bool is_const);
     void setInitVal(nodePtr val);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     void finalizeType(std::string type_name);
     std::string id;
+    symId sym = 0;
     struct Type *type;
     nodePtr init_val;
     bool is_const = false;
@@ -329,9 +340,7 @@ struct var_decl : public node {
     void setLoc(std::pair<size_t, size_t> loc);
     void setConst(bool is_const);
     std::string to_string() override ;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     bool is_const = false;
     std::string typeName;
     std::vector<vardefPtr> defs;
@@ -348,11 +357,8 @@ struct init_val : node {
     void setScalar(expPtr val);
     std::string to_string();
     void setLoc(std::pair<size_t, size_t>);
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
 public:
-    ASTKind kind = Init_Val;
     bool is_const = false;
     std::vector<initValPtr> children;
     expPtr scalar;
@@ -362,15 +368,14 @@ struct class_def : node {
 public:
     class_def(std::pair<size_t, size_t> loc);
     void addChild(nodePtr child);
-    void setName(std::string name);
+    void setName(std::string name, symId sym);
     void setLoc(std::pair<size_t, size_t> loc);
     std::string to_string() override;
     void reverseChildren() ;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
 public:
     std::string name;
+    symId sym = 0;
     std::vector<nodePtr> children;
     //only will be filled in by typechecker
     ClassType *type = nullptr;
@@ -379,9 +384,7 @@ public:
 struct member_access : expr {
     member_access(std::pair<size_t, size_t> loc, expPtr exp, const std::string &name);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr);
     std::string name;
     expPtr exp = nullptr;
@@ -392,9 +395,7 @@ struct member_access : expr {
 struct pointer_acc : expr {
     pointer_acc(std::pair<size_t, size_t> loc, expPtr exp, const std::string &name);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr);
     std::string name;
     expPtr exp = nullptr;
@@ -406,13 +407,45 @@ struct type_cast : expr {
     type_cast(std::pair<size_t, size_t> loc, expPtr exp, struct Type *target);
     type_cast(expPtr exp, struct Type *target);
     std::string to_string() override;
-    void printAST(std::string prefix, std::string info_prefix) override;
-    analyzeInfo dispatch(TypeChecker *ptr) ;
-    codeGenInfo dispatch(codeGen *ptr);
+    void printAST(std::string prefix, std::string info_prefix, std::ostream &out = std::cout) override;
     constInfo const_eval(TypeChecker *ptr);
     struct Type* target;
     expPtr exp = nullptr;
     bool isImplicit = true;
 };
 
+template <typename Derived, typename Ret>
+Ret ASTVisitor<Derived, Ret>::dispatch(node *n)
+{
+    Derived &self = static_cast<Derived &>(*this);
+    switch(n->kind) {
+        case Program: return self.visit(static_cast<program *>(n));
+        case Int_Literal: return self.visit(static_cast<int_literal *>(n));
+        case Unary_Op: return self.visit(static_cast<unary_expr *>(n));
+        case Binary_Op: return self.visit(static_cast<binary_expr *>(n));
+        case Subscript_Expr: return self.visit(static_cast<subscript_expr *>(n));
+        case Identifier: return self.visit(static_cast<identifier *>(n));
+        case Expr_Stmt: return self.visit(static_cast<expr_stmt *>(n));
+        case IF_ELSE_Stmt: return self.visit(static_cast<if_else_stmt *>(n));
+        case WHILE_Stmt: return self.visit(static_cast<while_stmt *>(n));
+        case Break_Stmt: return self.visit(static_cast<break_stmt *>(n));
+        case Continue_Stmt: return self.visit(static_cast<continue_stmt *>(n));
+        case Return_Stmt: return self.visit(static_cast<return_stmt *>(n));
+        case Block_Stmt: return self.visit(static_cast<block_stmt *>(n));
+        case Fun_Call: return self.visit(static_cast<fun_call *>(n));
+        case Func_Def: return self.visit(static_cast<func_def *>(n));
+        case Var_Def: return self.visit(static_cast<var_def *>(n));
+        case Var_Decl: return self.visit(static_cast<var_decl *>(n));
+        case Init_Val: return self.visit(static_cast<init_val *>(n));
+        case Class_Def: return self.visit(static_cast<class_def *>(n));
+        case Member_Access: return self.visit(static_cast<member_access *>(n));
+        case Pointer_Acc: return self.visit(static_cast<pointer_acc *>(n));
+        case Type_Cast: return self.visit(static_cast<type_cast *>(n));
+        default:
+            break;
+    }
+    std::cout << "no visit for " << n->to_string() << " " << locToString(n->location, "") << "\n";
+    exit(1);
+}
+
 #endif
\ No newline at end of file
@@ -63,6 +63,9 @@ enum symbolType {
 
     // OOP
     ClassDef, ClassBody, ClassMemberList, ClassMember, ConstructorDef,
+
+    // Number of symbols, not a symbol
+    SYMBOL_COUNT
 };
 
 
@@ -73,15 +76,25 @@ extern const std::unordered_map<symbolType, std::string> symbolTypeNames;
 struct parseInfo {
     public:
         parseInfo(parseInfo& p)
-        : str_val(p.str_val), type(p.type), location(p.location), ptr(std::move(p.ptr)) {}
+        : str_val(p.str_val), sym(p.sym), type(p.type), location(p.location), ptr(std::move(p.ptr)) {}
 
         parseInfo(std::pair<size_t, size_t> pair)
         : location(pair) {}
 
+        // One is made for every shift and reduce, so they are recycled per thread.
+        static void *operator new(size_t) { return slotPool<sizeof(parseInfo)>::allocate(); }
+        static void operator delete(void *p) { slotPool<sizeof(parseInfo)>::release(p); }
+
         void set_str(std::string str_val) {
             this->str_val = str_val;
         }
 
+        // Copies the spelling and the interned id of a name.
+        void set_name(const parseInfo &from) {
+            this->str_val = from.str_val;
+            this->sym = from.sym;
+        }
+
         void set_kind(symbolType kind) {
             this->kind = kind;
         }
@@ -96,6 +109,7 @@ struct parseInfo {
         
     public:
         std::string str_val;
+        symId sym = 0; // interned str_val, for ID tokens and the names built from them
         symbolType kind;
         std::pair<size_t, size_t> location;
         struct Type *type;
@@ -189,8 +203,6 @@ struct action {
     public:
         action(actionType type, size_t n)
         : type(type), n(n) {}
-        action(const action &a)
-        : type(a.type), n(a.n) {}
         action() {}
     public:
         actionType type;
@@ -210,20 +222,33 @@ struct parseTreeNode {
 using parserTreePtr = std::unique_ptr<parseTreeNode>;
 using firstFollowSet = std::unordered_map<symbolType, std::set<symbolType>>;
 using parseInfoPtr = std::unique_ptr<parseInfo>;
-using SemanticAction = std::function<parseInfoPtr(std::vector<parseInfoPtr>&)>;
+
+// The right-hand side of a reduction, in order, where it lies on top of the parser stack.
+struct infoSpan {
+    public:
+        parseInfoPtr &operator[](size_t i) const { return first[i]; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+    public:
+        parseInfoPtr *first;
+        size_t count;
+};
+
+// Semantic actions are captureless, so a reduction is one indirect call through the
+// action table, without std::function.
+using SemanticAction = parseInfoPtr (*)(infoSpan);
+
+// The action of rules without one: the value of the first symbol, if any.
+inline parseInfoPtr passFirstChild(infoSpan children) {
+    return children.empty() ? parseInfoPtr(nullptr) : std::move(children[0]);
+}
 
 struct ruleAction {
     public:
         ruleAction(struct rule rule, SemanticAction action)
         : rule(rule), action(action) {}
         ruleAction(struct rule rule)
-        : rule(rule), action([rule](std::vector<parseInfoPtr> &children){
-            if(children.size() > 0) {
-                return std::move(children[0]);
-            } else if(children.empty()) {
-                return parseInfoPtr(nullptr);
-            }
-        }){}
+        : rule(rule), action(passFirstChild) {}
     public:
         struct rule rule;
         SemanticAction action;
@@ -246,12 +271,237 @@ std::set<lrItem> computeClosure(const std::set<lrItem> &coreItems, const firstFo
 void printLR1Items(const std::set<lrItem>& items);
 lrState computeNextState(lrState state, symbolType edge, const firstFollowSet &firstSet); 
 using LRTable = std::vector<std::unordered_map<symbolType, action>>;
-LRTable computeLRTable(const firstFollowSet &firstSet, lrState start);
+
+/*
+    The table generator used by tools/genLRTable. Rules are indexed by left-hand side,
+    FIRST sets are computed once, items with the same core share one lookahead bitset and
+    states are found by a hash of their kernel. LALR1_TABLE merges the states whose
+    kernels have the same cores, which gives fewer states but can turn the table's
+    conflicts into reduce/reduce conflicts the LR(1) table does not have.
+*/
+enum lrTableMode {
+    LR1_TABLE,
+    LALR1_TABLE
+};
+LRTable buildLRTable(const std::vector<rule> &rules, lrTableMode mode = LR1_TABLE);
+
+/*
+    Unit rules A -> B whose action only passes B's value on cost the parser a reduction
+    and a goto each, and expressions go through a chain of them for every operand. The
+    table returned by bypassUnitRules takes them ahead of time: where a state would reduce
+    by one of unitRules (indexed by rule number), the goto that leads to it leads instead
+    to a new state acting as the state the reduction ends in. The parse is the same, the
+    reductions by those rules are not made and there are more states.
+*/
+LRTable bypassUnitRules(const LRTable &table, const std::vector<rule> &rules, const std::vector<bool> &unitRules);
+// The rules of parserRules bypassUnitRules may skip: one nonterminal, passFirstChild.
+std::vector<bool> passThroughUnitRules();
 void exportLRTableToCSV(const LRTable& table, const std::string& filename);
 extern const std::vector<rule> parserRules;
-parseResult Parse(std::vector<token> input, const LRTable &table, bool debug = false);
 LRTable importLRTableFromCSV(const std::string& filename);
 
+/*
+    Binary LR table format. A file holds exactly the in-memory layout of the table, so it
+    is mmapped and used in place without any parsing:
+        lrTableHeader
+        packedAction actions[numStates * numTerminals]               row-major, by state
+        uint32_t gotos[numStates * (numSymbols - numTerminals)]     row-major, by state
+    Terminals are the symbols below firstNonterminal; their SHIFT/REDUCE/ACC actions live
+    in `actions` and the GOTO targets of nonterminals in `gotos`. Both matrices are dense,
+    with lrNoAction marking an error entry, so a parser step is a single indexed load.
+    The header records the grammarHash of the rules the table was built from, and a table
+    is only accepted for the grammar compiled into the program. It also records the
+    lrTableMode, so an LR(1) and an LALR(1) table are told apart by their content.
+    All fields are native-endian 32-bit words, except grammarHash. Bump lrTableVersion
+    on any layout change.
+*/
+constexpr char lrTableMagic[8] = "HDU-LR";
+constexpr uint32_t lrTableVersion = 4;
+constexpr symbolType firstNonterminal = Declarator;
+
+struct lrTableHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numStates;
+    uint32_t numSymbols;
+    uint32_t numTerminals;
+    uint32_t mode;     // the lrTableMode the table was built in
+    uint32_t reserved; // zero, keeps grammarHash aligned
+    uint64_t grammarHash;
+};
+
+// An action packed into one word: the actionType in the top two bits, the target below.
+using packedAction = uint32_t;
+constexpr packedAction lrNoAction = 0xffffffff;
+constexpr uint32_t lrMaxTarget = 0x3ffffffe; // below the target bits of lrNoAction
+
+inline packedAction packAction(const action &a) {
+    return (uint32_t(a.type) << 30) | uint32_t(a.n);
+}
+
+inline action unpackAction(packedAction word) {
+    return action(actionType(word >> 30), word & 0x3fffffff);
+}
+
+inline actionType packedType(packedAction word) {
+    return actionType(word >> 30);
+}
+
+inline uint32_t packedTarget(packedAction word) {
+    return word & 0x3fffffff;
+}
+
+struct lrTableView {
+    public:
+        // The action of state on terminal sym, or lrNoAction.
+        packedAction actionAt(size_t state, symbolType sym) const {
+            return actions[state * numTerminals + sym];
+        }
+        // The state reached from state over nonterminal sym, or lrNoAction.
+        uint32_t gotoAt(size_t state, symbolType sym) const {
+            return gotos[state * numNonterminals + (sym - firstNonterminal)];
+        }
+        // Finds the action (or GOTO) of state on any symbol; returns false if there is none.
+        bool lookup(size_t state, symbolType sym, action &a) const;
+        size_t numStates() const { return header->numStates; }
+
+    public:
+        const lrTableHeader *header = nullptr;
+        const packedAction *actions = nullptr;
+        const uint32_t *gotos = nullptr;
+        size_t numTerminals = 0, numNonterminals = 0;
+};
+
+/*
+    Compressed in-memory forms of a dense table, by increasing level:
+        LR_DENSE           the matrices as they are
+        LR_DEFAULT_REDUCE  each state reduces by its most frequent rule on any lookahead
+                           it has no action for, and each nonterminal has a default goto
+                           target; states whose row is then empty have no row at all
+        LR_MERGED_ROWS     identical action rows and identical goto rows are stored once
+        LR_COMB            the distinct rows are overlaid into one vector by row
+                           displacement, with a check vector naming the owner of each slot
+    Default reductions only delay the detection of a syntax error to before the next
+    shift, so the accepted language is unchanged, but the state in an error message can
+    differ from the dense table.
+*/
+enum lrCompression {
+    LR_DENSE,
+    LR_DEFAULT_REDUCE,
+    LR_MERGED_ROWS,
+    LR_COMB
+};
+
+struct compressedLRTable {
+    public:
+        packedAction actionAt(size_t state, symbolType sym) const {
+            uint32_t row = actionRow[state];
+            packedAction word = lrNoAction;
+            if(row != noRow) {
+                if(actionBase.empty()) {
+                    word = actions[row * numTerminals + sym];
+                } else {
+                    size_t slot = actionBase[row] + sym;
+                    if(actionCheck[slot] == row) word = actions[slot];
+                }
+            }
+            return word != lrNoAction ? word : defaultAction[state];
+        }
+        uint32_t gotoAt(size_t state, symbolType sym) const {
+            size_t column = sym - firstNonterminal;
+            uint32_t row = gotoRow[state];
+            uint32_t target = lrNoAction;
+            if(row != noRow) {
+                if(gotoBase.empty()) {
+                    target = gotos[row * numNonterminals + column];
+                } else {
+                    size_t slot = gotoBase[row] + column;
+                    if(gotoCheck[slot] == row) target = gotos[slot];
+                }
+            }
+            return target != lrNoAction ? target : defaultGoto[column];
+        }
+        size_t numStates() const { return actionRow.size(); }
+        // Bytes held by all the vectors below.
+        size_t bytes() const;
+
+    public:
+        static constexpr uint32_t noRow = 0xffffffff;
+        lrCompression level;
+        size_t numTerminals, numNonterminals;
+        std::vector<packedAction> defaultAction;    // by state
+        std::vector<uint32_t> defaultGoto;          // by nonterminal
+        std::vector<uint32_t> actionRow, gotoRow;   // by state, the row holding its entries
+        std::vector<packedAction> actions;          // rows, or the comb with actionBase
+        std::vector<uint32_t> gotos;
+        std::vector<uint32_t> actionBase, gotoBase; // by row, for LR_COMB only
+        std::vector<uint32_t> actionCheck, gotoCheck;
+};
+
+compressedLRTable compressLRTable(const lrTableView &table, lrCompression level);
+
+// Fingerprint of the productions (not the actions); tables are valid for one grammar only.
+uint64_t grammarHash(const std::vector<rule> &rules);
+
+// Why a binary table image cannot be used with parserRules, or an empty string if it can.
+std::string checkLRTable(const void *data, size_t size);
+// As above, and the table must have been built in the given mode.
+std::string checkLRTable(const void *data, size_t size, lrTableMode mode);
+// Checks a binary table image and returns a view into it; exits if it cannot be used.
+lrTableView viewLRTable(const void *data, size_t size);
+// The binary image of a table built in the given mode from the rules with the given grammarHash.
+std::vector<uint32_t> serializeLRTable(const LRTable &table, uint64_t grammar, lrTableMode mode);
+void exportLRTableToBinary(const LRTable &table, uint64_t grammar, lrTableMode mode, const std::string &filename);
+
+// A binary table file mapped read-only for the lifetime of the object.
+struct mappedLRTable {
+    public:
+        mappedLRTable(const std::string &filename);
+        mappedLRTable(const mappedLRTable &) = delete;
+        mappedLRTable &operator=(const mappedLRTable &) = delete;
+        ~mappedLRTable();
+        // Maps a file without checking it; returns false if it cannot be read.
+        static bool map(const std::string &filename, void *&addr, size_t &size);
+
+    public:
+        lrTableView view;
+
+    private:
+        void *addr;
+        size_t size;
+};
+
+// The table of parserRules, compiled into the binary by tools/genLRTable.
+lrTableView builtinLRTable();
+
+/*
+    The table of parserRules kept in an on-disk cache, addressed by the grammar hash, the
+    mode and the format version, e.g. <dir>/lr1-2e3d3b30be1cfd17-v4.bin. A missing file,
+    or one whose header does not match (including its mode), is rebuilt with buildLRTable and replaced by
+    renaming, so concurrent compilers never see a partial table. If the cache cannot be
+    written, the rebuilt table is used from memory.
+*/
+struct lrTableCache {
+    public:
+        lrTableCache(const std::string &dir, lrTableMode mode = LR1_TABLE);
+        lrTableView view() const { return table; }
+
+    public:
+        std::string path;
+        bool hit; // the cached file was used as is
+
+    private:
+        lrTableView table;
+        std::unique_ptr<mappedLRTable> mapped;
+        std::vector<uint32_t> built; // only if the cache could not be written
+};
+
+// $HDU_CACHE_DIR, else $XDG_CACHE_HOME/hdu-compiler, else ~/.cache/hdu-compiler.
+std::string defaultCacheDir();
+
+parseResult Parse(tokenSource &input, const lrTableView &table, bool debug = false);
+parseResult Parse(tokenSource &input, const compressedLRTable &table, bool debug = false);
+
 
 
 #endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "common/common.hpp"
 #include "types/types.hpp"
+#include "lexer/interner.hpp"
+#include <optional>
 
 struct SymbolTable;
 using SymTblPtr = std::unique_ptr<SymbolTable>;
@@ -17,34 +19,73 @@ struct Type;
 struct Symbol {
     symbolKind kind;
     struct Type *type;
-    void *data;//index into the constant table
+    void *data;//the expr* initializer of a const scalar, or nullptr
 };
 
+/*
+    Scoped symbol table. One open-addressing hash table maps each name to its innermost
+    binding, and every binding links to the one it shadows, so a lookup is a single probe
+    whatever the depth. The bindings are kept in a stack in the order they were made, which
+    is also the undo log: endScope pops the bindings of the scope and restores what each
+    one shadowed, without building or freeing a map per scope.
+*/
 class SymbolTable {
 public:
-    std::vector<std::unordered_map<std::string, Symbol>> scopes;
     int depth = 0;
 public:
     SymbolTable();
 
     // insert a symbol into the current scope
-    bool insert(const std::string& symbol, Symbol sym);
+    bool insert(symId symbol, Symbol sym);
+
+    // the innermost binding of the symbol, if it is bound in any scope
+    std::optional<Symbol> lookup(symId symbol);
 
     // return true if the symbol exists in any scope
-    bool exists(const std::string& symbol);
+    bool exists(symId symbol);
 
     // return true if the symbol exists at current scope 
-    bool isInCurrentScope(const std::string& symbol);
+    bool isInCurrentScope(symId symbol);
 
-    bool isInGlobal(const std::string& symbol);
+    bool isInGlobal(symId symbol);
 
-    Symbol getFromGlobal(const std::string& symbol);
+    Symbol getFromGlobal(symId symbol);
 
     // get the item of the table
-    Symbol getValue(const std::string& symbol);
+    Symbol getValue(symId symbol);
     void beginScope();
     void endScope();
-    void printCurScope();
+    void printCurScope(std::ostream &out = std::cout);
+    // Prints the binding inserted last, in the format of printCurScope.
+    void printLastBinding(std::ostream &out = std::cout);
+
+    // the number of bindings in all open scopes
+    size_t size() const { return bindings.size(); }
+    // Binds the globals of other that come after the bindings of this table, up to its
+    // first count bindings. Both tables must be at the global scope, with this one holding
+    // a prefix of the bindings of other.
+    void insertGlobalsFrom(const SymbolTable &other, size_t count);
+
+private:
+    static constexpr uint32_t noBinding = UINT32_MAX;
+    struct binding {
+        Symbol sym;
+        symId name;
+        int depth;
+        uint32_t shadowed; // the binding of the same name in an outer scope, or noBinding
+    };
+    struct slot {
+        symId name = 0;    // 0 is an empty slot; names stay once added
+        uint32_t innermost = noBinding;
+    };
+
+    slot &find(symId symbol);
+    void grow();
+
+    std::vector<slot> slots;          // a power of two in size, probed linearly
+    size_t names = 0;                 // used slots
+    std::vector<binding> bindings;
+    std::vector<size_t> scopeStarts;  // the size of bindings at each beginScope
 };
 
 #endif
\ No newline at end of file
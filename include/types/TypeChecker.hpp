@@ -2,6 +2,9 @@
 #define __TYPECHECKER_H
 
 #include "common/common.hpp"
+#include "lexer/sourceManager.hpp"
+#include "lexer/interner.hpp"
+#include "parser/astnodes/astVisitor.hpp"
 // #include "symbolTable/symbolTable.hpp"
 
 struct node;
@@ -33,6 +36,7 @@ struct pointer_acc;
 
 struct identifier;
 struct subscript_expr;
+struct type_cast;
 
 
 struct Type;
@@ -43,19 +47,52 @@ struct ClassType;
 
 struct SymbolTable;
 struct Symbol;
+struct checkCache;
+struct checkedBody;
+struct flatAST;
 
 struct analyzeInfo {
     struct Type *type = nullptr;
 };
 
+enum constKind : uint8_t {
+    Const_Int,
+    Const_Char,
+    Const_Float,
+    Const_Bool
+};
+
+/*
+    A compile-time constant at the width the target gives its type: int is 32-bit two's
+    complement, char 8-bit, float IEEE single precision and bool 0 or 1.
+*/
+struct constValue {
+    constKind kind = Const_Int;
+    union {
+        int32_t i = 0;
+        int8_t c;
+        float f;
+        bool b;
+    };
+};
+
+// A reported error; dumpErrors prints it with its line of the source.
+struct typeError {
+    std::pair<size_t, size_t> location;
+    std::string message;
+};
+
 struct constInfo {
     bool is_const = false;
-    void *value = nullptr;
+    constValue value;
     struct Type *type = nullptr;
 };
 
-struct TypeChecker {
+struct TypeChecker : ASTVisitor<TypeChecker, analyzeInfo> {
     TypeChecker();
+    ~TypeChecker();
+    TypeChecker(const TypeChecker &) = delete;
+    TypeChecker &operator=(const TypeChecker &) = delete;
     analyzeInfo defaultResult;
 
     // Default value handling
@@ -63,8 +100,30 @@ struct TypeChecker {
         defaultResult = value;
     }
 
-    void setSource(std::vector<std::string> &&rows) {
-        this->source = std::move(rows);
+    // The file must outlive the checker; error messages quote its lines.
+    void setSource(const sourceFile &file) {
+        this->source = &file;
+    }
+
+    // The number of threads analyze(program*) checks function bodies on, 0 for one per
+    // core. With the default of 1 the program is checked serially.
+    void setThreads(size_t threads) {
+        this->threads = threads;
+    }
+
+    // Reuses the function bodies cache holds from earlier checks of the program, and
+    // keeps those of this check there. The cache must outlive the checker.
+    void setCache(checkCache *cache) {
+        this->cache = cache;
+    }
+
+    // Where the checker prints its trace, std::cout by default. The stream must outlive
+    // the checker; each checker has its own, so checkers on other threads never share one.
+    void setTrace(std::ostream &out) {
+        this->traceStream = &out;
+    }
+    std::ostream &trace() {
+        return *traceStream;
     }
 
     analyzeInfo analyze(class_def* node) ;
@@ -107,18 +166,29 @@ struct TypeChecker {
     void analyzeFunctionBody(func_def *node);
     void analyzeInit(var_def* node);
 
+    // Called by dispatch. A definition is checked together with its body or initializer;
+    // casts are only inserted by the checker and are not checked again.
+    template <typename Node>
+    analyzeInfo visit(Node *node) { return analyze(node); }
+    analyzeInfo visit(func_def *node);
+    analyzeInfo visit(var_def *node);
+    analyzeInfo visit(type_cast *) { return analyzeInfo(); }
+
     // Visit types
     analyzeInfo evaluate(ArrayType* node) ;
     analyzeInfo evaluate(FuncType* node) ;
 
     // Evaluate Const
+    // The const_eval of a checked expression, computed once and kept on the node.
+    constInfo constEval(expr *node);
     constInfo const_eval(unary_expr *ptr);
     constInfo const_eval(binary_expr* node) ;
     // constInfo const_eval(lval_expr* node) ;
+    constInfo const_eval(identifier *node);
     constInfo const_eval(fun_call* node) ;//always return false
     constInfo const_eval(int_literal* node);
 
-    void dumpErrors(std::string path);
+    void dumpErrors(std::string_view path);
     bool hasTypeError();
 private:
     void TypeError(node *ptr, const std::string &str);
@@ -129,6 +199,15 @@ private:
     void analyzeCompare(binary_expr *node);
     void analyzeEq(binary_expr *node);
     void analyzeDeref(unary_expr *node);
+    void analyzeParallel(program *node, size_t workers, checkCache *incremental);
+    uint64_t bodyKey(program *node, size_t item, std::string &key);
+    uint64_t globalSignature(symId name);
+    bool reuseBody(func_def *node, checkedBody *body);
+    void saveBody(func_def *node, size_t firstError, flatAST *flat, checkedBody &body);
+    // The check of each binary operator, by OpKind. An operator without one is left
+    // untyped, which is reported as a type error.
+    using binaryCheck = void (TypeChecker::*)(binary_expr *);
+    static const binaryCheck binaryChecks[];
     // Type checking state
     func_def *currentFuncDef;
     class_def *currentClassDef;
@@ -136,8 +215,15 @@ private:
     analyzeInfo currentReturnType;
     std::vector<size_t> controlFlowStack;
     size_t loopDepth;
-    std::vector<std::string> errorMessages;
-    std::vector<std::string> source;
+    std::vector<typeError> errorMessages;
+    const sourceFile *source = nullptr;
+    size_t threads = 1;
+    checkCache *cache = nullptr;
+    std::ostream *traceStream = &std::cout;
+    // While bodies are checked for a checkCache: the names used in the dimensions of the
+    // local arrays of the body being checked, which are folded away before saveBody.
+    bool noteDimensionNames = false;
+    std::vector<symId> dimensionNames;
 };
 
 
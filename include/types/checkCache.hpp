@@ -0,0 +1,58 @@
+#ifndef __CHECK_CACHE_H
+#define __CHECK_CACHE_H
+
+#include "parser/astnodes/flatAST.hpp"
+
+// A function body as it was checked, with what its check depended on.
+struct checkedBody {
+    public:
+        std::string key;                  // what its key hashes, compared on a hit
+        size_t line = 0;                  // of the definition when it was checked
+        // Shared by the bodies checked by one checker in one program, in which the
+        // nodes of this body are begin to end in preorder.
+        std::shared_ptr<flatAST> flat;
+        astHandle begin = 0, end = 0;
+        std::vector<astHandle> items;     // the checked statements of the body
+        std::string error_msg;            // given to the definition by the body check
+        std::vector<typeError> errors;    // reported while checking the body
+        // The names the body refers to, with a hash of their global binding at the
+        // definition, 0 for none.
+        std::vector<std::pair<symId, uint64_t>> globals;
+        bool used = false;
+};
+
+/*
+    The checked function bodies of earlier compilations, for checking a program again
+    after an edit (see TypeChecker::setCache). A body is keyed by its source text, from
+    the start of its definition to the start of the next top-level item, its column, its
+    checked signature and the error the signature check gave the definition, if any. It
+    is found by a hash of the key, and a hit compares the key itself, so two bodies whose
+    keys collide are never confused. It is reused when its key is found and every name
+    it refers to is bound to the same global as then, or still to none: the
+    checked statements are rebuilt in the current astArena, moved to the line the
+    definition is on now, and its errors are reported again. Other bodies are checked
+    and replace their entries, so the work of a check follows the size of the edit.
+
+    The cache is kept in memory and refers to types by pointer, so it serves the checkers
+    of one process. Entries the last program did not use are dropped, and programs with
+    classes are checked in full.
+*/
+struct checkCache {
+    public:
+        // The body whose key, with the given hash, is key, or nullptr.
+        checkedBody *find(uint64_t hash, const std::string &key);
+        // Keeps body under the hash of its key, in place of the one there was.
+        void store(uint64_t hash, checkedBody body);
+        // Around the check of a program; endProgram drops the entries it did not use.
+        void beginProgram();
+        void endProgram();
+        size_t size() const { return entries.size(); }
+
+    public:
+        size_t reused = 0, rechecked = 0;   // bodies of the last program
+
+    private:
+        std::unordered_map<uint64_t, checkedBody> entries;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef __CONST_EVAL_H
+#define __CONST_EVAL_H
+
+#include <optional>
+#include "parser/astnodes/node.hpp"
+
+/*
+    Folding of the operators on compile-time constants. The operands are converted as
+    the checker types them: char and bool are promoted to int, and either side being a
+    float makes the operation a float one. Integer arithmetic wraps at 32 bits like the
+    generated code; an operation whose result is undefined at run time (division by
+    zero, INT_MIN / -1, a shift by 32 or more) or that has no value (assignments, ++,
+    dereference) folds to nothing and is left to run time.
+*/
+std::optional<constValue> foldUnary(OpKind op, constValue operand);
+std::optional<constValue> foldBinary(OpKind op, constValue left, constValue right);
+
+constValue intConstant(int32_t value);
+constValue floatConstant(float value);
+// The checker's type of a constant.
+struct Type *constantType(const constValue &value);
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef __TYPES_H
 #define __TYPES_H
 
+#include <atomic>
+#include <mutex>
 #include "common/common.hpp"
+#include "lexer/interner.hpp"
 #include "types/TypeChecker.hpp"
 
 //forward decl
@@ -34,7 +37,7 @@ enum TypeKind {
 };
 
 struct HasBindings {
-    std::vector<std::string> bindings;
+    std::vector<symId> bindings; // interned parameter names
 };
 
 
@@ -43,15 +46,22 @@ struct Type {
     public:
         Type(TypeKind kind);
         Type(TypeKind kind, size_t size);
+        virtual ~Type() = default;
         virtual std::string to_string() = 0;
         virtual bool equals(Type* other) = 0;
         virtual void setConst() = 0;
         virtual void evaluate(TypeChecker *ptr) = 0;
+        // equals for the checker: a pointer compare when both types come from TypeFactory::canonical
+        bool sameAs(Type *other) {
+            if(unqualified != nullptr && other != nullptr && other->unqualified != nullptr) return unqualified == other->unqualified;
+            return equals(other);
+        }
 
     public:
         TypeKind kind;    
         size_t size; //memory size
         bool is_const = false;
+        Type *unqualified = nullptr; // set on canonical types only: the canonical type without any const
     public:
         std::vector<std::string> errorMsgs;
         bool hasError = false;
@@ -83,7 +93,7 @@ struct ArrayType : public Type {
     void evaluate(TypeChecker *ptr);
     std::string to_string() override;
     Type *degrade();
-    void printUnevaludatedType(std::string prefix, std::string info_prefix);
+    void printUnevaludatedType(std::string prefix, std::string info_prefix, std::ostream &out = std::cout);
     bool equals(Type* other) override;
     void setConst();
     TypeKind kind;
@@ -159,9 +169,23 @@ struct ClassVarType : Type {
     std::string to_string() override;
     void setConst() override;
     std::string classname;
+    symId classSym;
 };
 
 
+/*
+    Types of the same structure are hash-consed: canonical, getArrayOf, getPointerTo,
+    getClassVar and getConst return the one instance per (kind, const, element, dims or
+    depth, class), so a canonical type must never be modified; const is part of the key
+    instead of a flag set on a shared type. Canonical types are compared with sameAs.
+    Function types are not shared, one is built per definition with getFunction since it
+    carries the parameter names and is completed by the checker, but their parameter and
+    return types are canonical. Class and error types are never canonical.
+    The primitive types are built once and never change, so getInt and the like take no
+    lock. The table of the other canonical types is shared by all threads and guarded by
+    one lock, as the checker may run on several; every thread looks in its own cache of
+    the types it has seen first, so only the first lookup of a type takes the lock.
+*/
 struct TypeFactory {
     public:
         static struct Type *getTypeFromName(const std::string& type_name);
@@ -170,16 +194,42 @@ struct TypeFactory {
         static struct Type *getFloat(); 
         static struct Type *getChar();
         static struct Type *getBool();
-        static struct Type *getArray();
+        static ArrayType *getArrayOf(struct Type *element, const std::vector<size_t> &dims);
         static ClassVarType *getClassVar(std::string classname);
-        static PointerType *getPointer();
-        static PointerType *getPointerTo(struct Type *ptr);
+        static PointerType *getPointerTo(struct Type *ptr, size_t depth = 1);
         static FuncType *getFunction();
+        static struct Type *canonical(struct Type *type);
+        static struct Type *getConst(struct Type *type);
+        static size_t canonicalCount();
         static void deleteAll();
     private:
-        static struct Type* makePrimitive(TypeKind kind, size_t size);
-        static std::map<TypeKind,struct Type*> primitives;
+        // The structure of a type whose parts are canonical, compared without building the type.
+        struct typeKey {
+            TypeKind kind;
+            bool is_const = false;
+            size_t size = 0;
+            struct Type *element = nullptr;           // of an array or a pointer
+            size_t depth = 0;                         // of a pointer
+            symId classSym = 0;                       // of a class variable
+            const std::vector<size_t> *dims = nullptr; // of an array, owned by the caller or the type
+            bool operator==(const typeKey &other) const;
+        };
+        struct typeKeyHash {
+            size_t operator()(const typeKey &key) const;
+        };
+        using typeTable = std::unordered_map<typeKey, struct Type*, typeKeyHash>;
+
+    private:
+        static struct Type *primitive(TypeKind kind);
+        static typeKey keyOf(struct Type *type);
+        static struct Type *unqualifiedOf(struct Type *type);
+        template<class Make> static struct Type *intern(const typeKey &key, Make make);
         static std::vector<struct Type*> typePool;
+        static typeTable canonicalTypes;
+        static std::mutex lock;
+        static std::atomic<uint64_t> generation; // bumped by deleteAll, which empties the caches
+        static thread_local typeTable seenTypes;
+        static thread_local uint64_t seenGeneration;
 };
 
 #endif
\ No newline at end of file
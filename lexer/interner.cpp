@@ -0,0 +1,47 @@
+#include "lexer/interner.hpp"
+
+std::mutex Interner::lock;
+std::string *Interner::chunks[chunkCount] = {new std::string[firstChunk]};
+std::atomic<size_t> Interner::count(1);
+std::unordered_map<std::string_view, symId> Interner::ids = {{chunks[0][0], 0}};
+
+size_t Interner::chunkOf(size_t id) {
+    // chunk k starts at (2^k - 1) * firstChunk
+    return 63 - __builtin_clzll(id / firstChunk + 1);
+}
+
+std::string &Interner::slot(size_t id) {
+    size_t k = chunkOf(id);
+    return chunks[k][id - ((size_t(1) << k) - 1) * firstChunk];
+}
+
+symId Interner::intern(std::string_view str) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = ids.find(str);
+    if(it != ids.end()) {
+        return it->second;
+    }
+    size_t id = count.load(std::memory_order_relaxed);
+    if(id > UINT32_MAX) {
+        std::cout << "Error: too many distinct identifiers\n";
+        exit(1);
+    }
+    size_t k = chunkOf(id);
+    if(!chunks[k]) {
+        chunks[k] = new std::string[firstChunk << k];
+    }
+    std::string &spelling = slot(id);
+    spelling = str;
+    ids.emplace(spelling, id);
+    // the chunk and the spelling are visible to any thread that sees the new count
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+std::string_view Interner::spelling(symId id) {
+    if(id >= count.load(std::memory_order_acquire)) {
+        std::cout << "Error: symbol " << id << " was never interned\n";
+        exit(1);
+    }
+    return slot(id);
+}
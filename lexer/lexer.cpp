@@ -1,118 +1,68 @@
+#include <cstring>
+#include <thread>
 #include "lexer/lexer.hpp"
 
-std::string readSrc(std::string path) {
-    std::ifstream srcfile(path);
-    if(!srcfile.is_open()) {
-        std::cout << "Error: Could not open file " << path << "'\n";
-    }
-    return std::move(std::string(
-        (std::istreambuf_iterator<char>(srcfile)),
-        std::istreambuf_iterator<char>()
-    ));
-}
-
-
-size_t read_id_keyword(const std::string &code, size_t start) {
-    size_t i = start;
-    std::string str;
-    while(isalpha(code[i]) || isdigit(code[i]) || code[i] == '_') {
-        str += code[i];
-        i++;
-    }
-    return i;
-}
-
-size_t read_num(const std::string &code, size_t start) {
-    size_t i = start;
-    std::string str;
-    if(code[i] == '0' && (code[i+1] == 'x' || code[i+1] == 'X')) {
-        i+=2;
-        while(i < code.size() && (isdigit(code[i]) || (tolower(code[i]) >= 'a' && tolower(code[i]) <= 'f')))
-            i++;
-    } else {
-        while(isdigit(code[i]) && i < code.size()) i++;
-    }
-    return i;
-}
+/*
+    Keywords are recognized by a perfect hash on (length, first char, last char) into a
+    table built at compile time. Classifying an identifier is one probe plus one memcmp;
+    anything that does not match the spelling in its slot is an ID.
+*/
+struct keywordSpelling {
+    const char *text = nullptr;
+    size_t length = 0;
+    token::tokenType type = token::ID;
+};
 
-const std::map<std::string, token::tokenType> keywords = {
-    {"if", token::KW_IF},
-    {"else", token::KW_ELSE},
-    {"while", token::KW_WHILE},
-    {"for", token::KW_FOR},
-    {"return", token::KW_RETURN},
-    {"function", token::KW_FUNCTION},
-    {"break", token::KW_BREAK},
-    {"continue", token::KW_CONTINUE},
+constexpr keywordSpelling keywords[] = {
+    {"if", 2, token::KW_IF},
+    {"else", 4, token::KW_ELSE},
+    {"while", 5, token::KW_WHILE},
+    {"for", 3, token::KW_FOR},
+    {"return", 6, token::KW_RETURN},
+    {"function", 8, token::KW_FUNCTION},
+    {"break", 5, token::KW_BREAK},
+    {"continue", 8, token::KW_CONTINUE},
 
     //Class
-    {"class", token::KW_CLASS},
-    {"struct", token::KW_STRUCT},
+    {"class", 5, token::KW_CLASS},
+    {"struct", 6, token::KW_STRUCT},
 
     //Types
-    {"int", token::KW_INT},
-    {"void", token::KW_VOID},
-    {"float", token::KW_FLOAT},
-    {"char", token::KW_CHAR},
-    {"const", token::KW_CONST}
-};
-
-const std::map<std::string, token::tokenType> separators = {
-    {"(", token::tokenType::LPR},
-    {")", token::tokenType::RPR},
-    {"[", token::tokenType::LBK},
-    {"]", token::tokenType::RBK},
-    {"{", token::tokenType::LBC},
-    {"}", token::tokenType::RBC},
-    {",", token::tokenType::COMMA},
-    {";", token::tokenType::SEMICOLON}
+    {"int", 3, token::KW_INT},
+    {"void", 4, token::KW_VOID},
+    {"float", 5, token::KW_FLOAT},
+    {"char", 4, token::KW_CHAR},
+    {"const", 5, token::KW_CONST}
 };
 
-const std::map<std::string, token::tokenType> operators = {
-    // Arithmetic
-    {"+", token::PLUS}, {"-", token::MINUS},
-    {"*", token::STAR}, {"/", token::SLASH},
-    {"%", token::PERCENT},
-    {"++", token::PLUS_PLUS}, {"--", token::MINUS_MINUS},
-    {"+=", token::PLUS_EQ}, {"-=", token::MINUS_EQ},
-    {"*=", token::STAR_EQ}, {"/=", token::SLASH_EQ},
-    {"%=", token::PERCENT_EQ},
-
-    // Comparison
-    {"==", token::EQ}, {"!=", token::NEQ},
-    {"<", token::LT}, {">", token::GT},
-    {"<=", token::LTE}, {">=", token::GTE},
-
-    // Logical
-    {"&&", token::AND}, {"||", token::OR},
-    {"!", token::NOT},
-
-    // Bitwise
-    {"&", token::BIT_AND}, {"|", token::BIT_OR},
-    {"^", token::BIT_XOR},
-    {"<<", token::SHL}, {">>", token::SHR},
+constexpr size_t keywordSlots = 32;
 
-    // Assign
-    {"=", token::tokenType::ASSIGN},
+constexpr size_t keywordHash(const char *str, size_t len) {
+    return (len + 5 * (unsigned char)str[0] + (unsigned char)str[len - 1]) & (keywordSlots - 1);
+}
 
-    // Member Access
-    {".", token::tokenType::DOT},
-    {"->", token::tokenType::POINTER_ACC}
-};
+struct keywordTable {
+    keywordSpelling slots[keywordSlots] = {};
+    bool perfect = true;
 
-size_t read_operator(const std::string &code, size_t start) {
-    if(operators.count(code.substr(start, 1))) {
-        if(operators.count(code.substr(start, 2))) {
-            return start + 2; 
+    constexpr keywordTable() {
+        for(const auto &kw : keywords) {
+            size_t h = keywordHash(kw.text, kw.length);
+            if(slots[h].text != nullptr || kw.text[kw.length] != '\0') perfect = false;
+            slots[h] = kw;
         }
-        return start + 1;
     }
-    return start;
-}
+};
 
-bool is_keyword(std::string str) {
-    std::cout << str << keywords.count(str) << "\n";
-    return keywords.count(str) > 0;
+constexpr keywordTable keywordTab;
+static_assert(keywordTab.perfect, "keyword hash collides, pick other multipliers in keywordHash");
+
+token::tokenType classifyIdentifier(const char *str, size_t len) {
+    const keywordSpelling &kw = keywordTab.slots[keywordHash(str, len)];
+    if(kw.length == len && std::memcmp(kw.text, str, len) == 0) {
+        return kw.type;
+    }
+    return token::ID;
 }
 
 std::string token_serialize(const token& token) {
@@ -175,73 +125,311 @@ std::string token_serialize(const token& token) {
 }
 
 
-lexInfo tokenize(const std::string &code) {
-    size_t row = 1, col = 1, i = 0;
-    std::vector<token> tokens;
-
-    std::vector<std::string> rows; // for debugging purpose
-    size_t row_begin = 0; // record the position of the beginning of the row
-    while(i != code.size()) {
-        char cur = code[i];
-        if(code.substr(i, 2) == "/*") {
-            i += 2;
-            while(code.substr(i, 2) != "*/" && i < code.size()) i++;
-            i += 2;
-        } else if(cur == ' ') {
-            i++;
-            col++;
-        } else if(cur == '\n') {
-            rows.push_back(code.substr(row_begin, i - row_begin + 1));
-            i++;
-            row_begin = i;
-            row++;
-            col = 1;
-        } else if(isalpha(cur) || cur == '_'){
-            size_t end = read_id_keyword(code, i);
-            std::string str = code.substr(i, end - i);
-            if(is_keyword(str)) {
-                auto tokenType = keywords.at(str);
-                tokens.emplace_back(tokenType, str, row, col);
-            } else {
-                tokens.emplace_back(token::tokenType::ID, str, row, col);
-            } 
-            col += end - i;
-            i = end;
-        } else if(isdigit(cur)){
-            size_t end = read_num(code, i);
-            tokens.emplace_back(token::tokenType::NUM, code.substr(i, end - i), row, col);
-            col += end - i;
-            i = end;
-        } else if(separators.find(std::string(1, cur)) != separators.end()) {
-            tokens.emplace_back(separators.at(std::string(1, cur)), std::string(1, code[i]), row, col);
-            col++;
-            i++;
-        } else if(code.substr(i, 2) == "//") {
-            while(code[i] != '\n' && i < code.size()) {
-                i++;
-                col++;
-            } 
-        } else if(read_operator(code, i) > i) {
-            size_t end = read_operator(code, i);
-            tokens.emplace_back(operators.at(code.substr(i, end - i)), code.substr(i, end - i), row, col);
-            col += end - i;
-            i = end;
-        } else {
-            // std::cout << "row: " << row << "col: " << col << " of " << code.substr(i, 2) << std::endl;
-            i++;
+/*
+    The scanner is a table-driven DFA. Every input byte is first mapped to a character
+    class, and the next state is looked up by (state, class). Both tables are built at
+    compile time by the constexpr constructor of lexTables below.
+
+    A token is the longest prefix accepted from LS_START, and the state the automaton
+    stops in decides what is emitted. Punctuation states are numbered LS_PUNCT + tokenType,
+    so the token kind of an operator or separator falls out of the state directly.
+*/
+enum lexClass : uint8_t {
+    CC_OTHER, CC_SPACE, CC_NEWLINE,
+    CC_LETTER, CC_HEX_LETTER, CC_X, // [g-wyzG-WYZ_], [a-fA-F], [xX]
+    CC_ZERO, CC_DIGIT,              // 0, [1-9]
+    CC_PUNCT                        // CC_PUNCT + k is the class of punctChars[k]
+};
+
+constexpr char punctChars[] = "()[]{},;+-*/%=!<>&|^.";
+constexpr size_t numClasses = CC_PUNCT + sizeof(punctChars) - 1;
+
+enum lexState : uint8_t {
+    LS_START,
+    LS_SPACE, LS_NEWLINE, LS_OTHER,
+    LS_ID,
+    LS_ZERO, LS_DEC, LS_HEX,
+    LS_LINE_COMMENT, LS_BLOCK_COMMENT, LS_BLOCK_STAR, LS_BLOCK_END,
+    LS_PUNCT,                                   // LS_PUNCT + t accepts token t
+    LS_DEAD = LS_PUNCT + token::POINTER_ACC + 1 // no transition
+};
+constexpr size_t numStates = LS_DEAD;
+
+struct punctSpelling {
+    const char *text;
+    token::tokenType type;
+};
+
+// Single characters must come before the two-character operators extending them.
+constexpr punctSpelling punctuations[] = {
+    // Separators
+    {"(", token::LPR}, {")", token::RPR},
+    {"[", token::LBK}, {"]", token::RBK},
+    {"{", token::LBC}, {"}", token::RBC},
+    {",", token::COMMA}, {";", token::SEMICOLON},
+
+    // Single-character operators
+    {"+", token::PLUS}, {"-", token::MINUS},
+    {"*", token::STAR}, {"/", token::SLASH},
+    {"%", token::PERCENT}, {"=", token::ASSIGN},
+    {"!", token::NOT},
+    {"<", token::LT}, {">", token::GT},
+    {"&", token::BIT_AND}, {"|", token::BIT_OR},
+    {"^", token::BIT_XOR}, {".", token::DOT},
+
+    // Two-character operators
+    {"++", token::PLUS_PLUS}, {"--", token::MINUS_MINUS},
+    {"+=", token::PLUS_EQ}, {"-=", token::MINUS_EQ},
+    {"*=", token::STAR_EQ}, {"/=", token::SLASH_EQ},
+    {"%=", token::PERCENT_EQ},
+    {"==", token::EQ}, {"!=", token::NEQ},
+    {"<=", token::LTE}, {">=", token::GTE},
+    {"&&", token::AND}, {"||", token::OR},
+    {"<<", token::SHL}, {">>", token::SHR},
+    {"->", token::POINTER_ACC}
+};
+
+struct lexTables {
+    uint8_t charClass[256] = {};
+    uint8_t next[numStates][numClasses] = {};
+
+    constexpr lexTables() {
+        for(size_t s = 0; s < numStates; s++) {
+            for(size_t c = 0; c < numClasses; c++) {
+                next[s][c] = LS_DEAD;
+            }
+        }
+
+        // character classes
+        for(int c = 0; c < 26; c++) {
+            charClass['a' + c] = charClass['A' + c] = c < 6 ? CC_HEX_LETTER : CC_LETTER;
+        }
+        charClass['x'] = charClass['X'] = CC_X;
+        charClass['_'] = CC_LETTER;
+        charClass['0'] = CC_ZERO;
+        for(int c = '1'; c <= '9'; c++) {
+            charClass[c] = CC_DIGIT;
         }
+        charClass[' '] = CC_SPACE;
+        charClass['\n'] = CC_NEWLINE;
+        for(size_t k = 0; punctChars[k]; k++) {
+            charClass[(unsigned char)punctChars[k]] = CC_PUNCT + k;
+        }
+
+        // anything unrecognized is skipped one byte at a time
+        for(size_t c = 0; c < numClasses; c++) {
+            next[LS_START][c] = LS_OTHER;
+        }
+        next[LS_START][CC_SPACE] = LS_SPACE;
+        next[LS_SPACE][CC_SPACE] = LS_SPACE;
+        next[LS_START][CC_NEWLINE] = LS_NEWLINE;
+
+        // identifiers and keywords
+        for(auto c : {CC_LETTER, CC_HEX_LETTER, CC_X}) {
+            next[LS_START][c] = LS_ID;
+        }
+        for(auto c : {CC_LETTER, CC_HEX_LETTER, CC_X, CC_ZERO, CC_DIGIT}) {
+            next[LS_ID][c] = LS_ID;
+        }
+
+        // decimal and hexadecimal numbers
+        next[LS_START][CC_ZERO] = LS_ZERO;
+        next[LS_START][CC_DIGIT] = LS_DEC;
+        for(auto c : {CC_ZERO, CC_DIGIT}) {
+            next[LS_ZERO][c] = LS_DEC;
+            next[LS_DEC][c] = LS_DEC;
+            next[LS_HEX][c] = LS_HEX;
+        }
+        next[LS_ZERO][CC_X] = LS_HEX;
+        next[LS_HEX][CC_HEX_LETTER] = LS_HEX;
+
+        // separators and operators
+        for(const auto &p : punctuations) {
+            uint8_t from = LS_START;
+            const char *last = p.text;
+            if(p.text[1]) {
+                from = next[LS_START][charClass[(unsigned char)p.text[0]]];
+                last++;
+            }
+            next[from][charClass[(unsigned char)*last]] = LS_PUNCT + p.type;
+        }
+
+        // comments
+        const uint8_t slash = LS_PUNCT + token::SLASH;
+        next[slash][charClass['/']] = LS_LINE_COMMENT;
+        next[slash][charClass['*']] = LS_BLOCK_COMMENT;
+        for(size_t c = 0; c < numClasses; c++) {
+            next[LS_LINE_COMMENT][c] = LS_LINE_COMMENT;
+            next[LS_BLOCK_COMMENT][c] = LS_BLOCK_COMMENT;
+            next[LS_BLOCK_STAR][c] = LS_BLOCK_COMMENT;
+        }
+        next[LS_LINE_COMMENT][CC_NEWLINE] = LS_DEAD;
+        next[LS_BLOCK_COMMENT][charClass['*']] = LS_BLOCK_STAR;
+        next[LS_BLOCK_STAR][charClass['*']] = LS_BLOCK_STAR;
+        next[LS_BLOCK_STAR][charClass['/']] = LS_BLOCK_END;
     }
-    return lexInfo{
-        .tokens = tokens,
-        .rows = rows
+};
+
+constexpr lexTables dfa;
+
+bool tokenSource::next() {
+    std::string_view code = file->text;
+    const size_t n = limit;
+    while(pos != n) {
+        size_t i = pos;
+        uint8_t state = LS_START;
+        size_t end = i;
+        while(end != n) {
+            uint8_t next = dfa.next[state][dfa.charClass[(unsigned char)code[end]]];
+            if(next == LS_DEAD) break;
+            state = next;
+            end++;
+        }
+        pos = end;
+        switch(state) {
+            case LS_SPACE:
+            case LS_NEWLINE:
+            case LS_LINE_COMMENT:
+            case LS_OTHER:
+            case LS_BLOCK_COMMENT: // unterminated, runs to the end of the file
+            case LS_BLOCK_STAR:
+            case LS_BLOCK_END:
+                continue;
+            case LS_ID:
+                kind = classifyIdentifier(code.data() + i, end - i);
+                break;
+            case LS_ZERO:
+            case LS_DEC:
+            case LS_HEX:
+                kind = token::tokenType::NUM;
+                break;
+            default:
+                kind = token::tokenType(state - LS_PUNCT);
+                break;
+        }
+        offset = i;
+        length = end - i;
+        return true;
+    }
+    kind = token::END_OF_FILE;
+    offset = n;
+    length = 0;
+    return false;
+}
+
+/*
+    Splits code into at most `chunks` pieces that can be lexed independently. Every piece
+    except the last ends right after a '\n' that is not inside a block comment, so the
+    DFA is back in its start state there. Only comments matter for that: no token can
+    contain '/' after its first character, so slash-slash and slash-star start comments
+    exactly where the lexer would see them. The scan jumps between the few interesting
+    characters with memchr, which glibc vectorizes. Returns the chunk starts plus
+    code.size().
+*/
+std::vector<size_t> findChunkBoundaries(std::string_view code, size_t chunks) {
+    const char *begin = code.data(), *end = begin + code.size();
+    auto find = [end](const char *from, char c) {
+        const char *p = from < end ? (const char *)memchr(from, c, end - from) : nullptr;
+        return p ? p : end;
     };
+
+    std::vector<size_t> bounds = {0};
+    const char *p = begin;
+    for(size_t k = 1; k < chunks && p != end; k++) {
+        const char *target = begin + code.size() * k / chunks;
+        while(p != end) {
+            const char *slash = find(p, '/');
+            if(p >= target || slash >= target) {
+                // no comment can open between p and the next newline past target
+                const char *newline = find(std::max(p, target), '\n');
+                if(slash > newline) {
+                    p = newline == end ? end : newline + 1;
+                    break;
+                }
+            }
+            if(slash + 1 >= end) {
+                p = end;
+            } else if(slash[1] == '/') {
+                p = find(slash + 2, '\n');
+            } else if(slash[1] == '*') {
+                // ends at the first '/' after a '*' that is not the opening one
+                const char *close = slash + 2;
+                while((close = find(close, '/')) != end && (close == slash + 2 || close[-1] != '*')) {
+                    close++;
+                }
+                p = close == end ? end : close + 1;
+            } else {
+                p = slash + 1;
+            }
+        }
+        if(p != end && (size_t)(p - begin) > bounds.back()) {
+            bounds.push_back(p - begin);
+        }
+    }
+    bounds.push_back(code.size());
+    return bounds;
+}
+
+// Chunks smaller than this are not worth a thread.
+constexpr size_t minChunkSize = 1 << 20;
+
+lexInfo tokenize(const sourceFile &file, size_t threads) {
+    lexInfo info;
+    info.file = &file;
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, file.text.size() / minChunkSize);
+
+    if(threads <= 1) {
+        tokenSource src(file);
+        while(src.next()) {
+            info.kinds.push_back(src.kind);
+            info.offsets.push_back(src.offset);
+            info.lengths.push_back(src.length);
+        }
+        return info;
+    }
+
+    // Offsets are file-relative, so the chunks only need to be concatenated; rows and
+    // columns come from the sourceFile and need no correction.
+    std::vector<size_t> bounds = findChunkBoundaries(file.text, threads);
+    std::vector<lexInfo> parts(bounds.size() - 1);
+    std::vector<std::thread> workers;
+    for(size_t k = 0; k < parts.size(); k++) {
+        workers.emplace_back([&, k] {
+            tokenSource src(file, bounds[k], bounds[k + 1]);
+            while(src.next()) {
+                parts[k].kinds.push_back(src.kind);
+                parts[k].offsets.push_back(src.offset);
+                parts[k].lengths.push_back(src.length);
+            }
+        });
+    }
+    for(auto &w : workers) {
+        w.join();
+    }
+
+    size_t total = 0;
+    for(const auto &part : parts) {
+        total += part.size();
+    }
+    info.kinds.reserve(total);
+    info.offsets.reserve(total);
+    info.lengths.reserve(total);
+    for(const auto &part : parts) {
+        info.kinds.insert(info.kinds.end(), part.kinds.begin(), part.kinds.end());
+        info.offsets.insert(info.offsets.end(), part.offsets.begin(), part.offsets.end());
+        info.lengths.insert(info.lengths.end(), part.lengths.begin(), part.lengths.end());
+    }
+    return info;
 }
 
-void printTokens(const std::vector<token> &tokens) {
+void printTokens(const lexInfo &tokens) {
     std::cout << "Tokens of The Source Program\n";
     std::cout << "-----------------------------\n";
     for(size_t i = 0; i < tokens.size(); i++) {
-        std::cout << i << ") " << token_serialize(tokens[i]);
+        std::cout << i << ") " << token_serialize(tokens.at(i));
     }
     std::cout << "-----------------------------\n";
     std::cout << "Count " << tokens.size() << " tokens \n";
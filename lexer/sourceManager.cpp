@@ -0,0 +1,73 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include "lexer/sourceManager.hpp"
+
+const std::vector<uint32_t> &sourceFile::lineStarts() const {
+    std::call_once(indexed, [this] {
+        starts.push_back(0);
+        const char *begin = text.data(), *end = begin + text.size();
+        for(const char *p = begin; (p = (const char *)memchr(p, '\n', end - p)) != nullptr; ) {
+            p++;
+            starts.push_back(p - begin);
+        }
+    });
+    return starts;
+}
+
+std::pair<size_t, size_t> sourceFile::locate(size_t offset) const {
+    const auto &lines = lineStarts();
+    // the last line starting at or before offset
+    auto it = std::upper_bound(lines.begin(), lines.end(), offset);
+    size_t row = it - lines.begin();
+    return {row, offset - lines[row - 1] + 1};
+}
+
+std::string_view sourceFile::line(size_t row) const {
+    const auto &lines = lineStarts();
+    size_t begin = lines[row - 1];
+    size_t end = row < lines.size() ? lines[row] : text.size();
+    return text.substr(begin, end - begin);
+}
+
+const sourceFile &SourceManager::load(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        std::cout << "Error: Could not open file '" << path << "'\n";
+        exit(1);
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        std::cout << "Error: Could not stat file '" << path << "'\n";
+        exit(1);
+    }
+    size_t size = st.st_size;
+    if(size > UINT32_MAX) {
+        std::cout << "Error: source file '" << path << "' is larger than 4GB\n";
+        exit(1);
+    }
+
+    const char *data = "";
+    if(size != 0) { // mmap rejects empty mappings
+        void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED) {
+            std::cout << "Error: Could not map file '" << path << "'\n";
+            exit(1);
+        }
+        madvise(addr, size, MADV_SEQUENTIAL);
+        mappings.push_back(mapping{.addr = addr, .size = size});
+        data = (const char *)addr;
+    }
+    close(fd);
+
+    files.push_back(std::make_unique<sourceFile>(path, std::string_view(data, size)));
+    return *files.back();
+}
+
+SourceManager::~SourceManager() {
+    for(const auto &m : mappings) {
+        munmap(m.addr, m.size);
+    }
+}
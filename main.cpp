@@ -22,9 +22,11 @@
 
 int (main) (int argc, char* argv[]) {
 //     assert(argc == 2);
-//     auto info = tokenize(readSrc(std::string(argv[1]))); // after initializing tc with rows, it will become no longer valid.
-//     const auto &tokens = info.tokens;
-// //     printTokens(tokens);
+//     SourceManager sources; // the tokens and the diagnostics point into its files
+//     const sourceFile &file = sources.load(argv[1]);
+//     astArena arena; // holds the AST until the end of the compilation
+//     astArena::scope useArena(arena);
+// //     printTokens(tokenize(file));
 // // //     // printAllRules(parserRules);
 // // #ifdef GenerateParser
 // //     const auto &firstSets = computeFirstSet(parserRules);
@@ -33,10 +35,14 @@ int (main) (int argc, char* argv[]) {
 // // //     // printFirstOrFollowSets(followSets, false);
 // //     lrState start(computeClosure({lrItem(parserRules[0], 0, END_OF_FILE)}, firstSets));
 // // //     // printLR1Items(computeNextState(start, ID, firstSets).items);
-// //     const auto &table = computeLRTable(firstSets, start);
+// //     const auto &table = buildLRTable(parserRules); // or LALR1_TABLE
 // //     exportLRTableToCSV(table, "table.csv");
+// //     exportLRTableToBinary(table, grammarHash(parserRules), LR1_TABLE, "table.bin");
 // // #endif
-//     LRTable table1 = importLRTableFromCSV("table.csv");
+//     lrTableView table1 = builtinLRTable(); // generated at build time, see tools/genLRTable
+//     // lrTableCache cache(defaultCacheDir(), LALR1_TABLE); // built once per grammar, then mapped
+//     // lrTableView table1 = cache.view();
+//     tokenSource tokens(file); // lexed on demand by the parser
 //     auto result = std::move(Parse(tokens, table1, true));
 
 //     if(result.node == nullptr) {
@@ -45,10 +51,10 @@ int (main) (int argc, char* argv[]) {
 //     result.node->ptr->printAST("", "");
 
 //     TypeChecker *ptr = new TypeChecker;
-//     ptr->setSource(std::move(info.rows));// move assignment
+//     ptr->setSource(file);
 //     ptr->analyze(dynamic_cast<program*>(result.node->ptr.get()));
 //     result.node->ptr.get()->printAST("", "");
-//     ptr->dumpErrors(std::string(argv[1]));
+//     ptr->dumpErrors(file.path);
 //     if(ptr->hasTypeError()) {
 //         // std::cout << "\nThe program has semantics error, thus compilation stops.\n";
 //         return 1;
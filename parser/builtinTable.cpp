@@ -0,0 +1,8 @@
+#include "parser/parser.hpp"
+
+// Generated into $(BUILD_DIR)/generated by tools/genLRTable; see the Makefile.
+#include "lrTableData.inc"
+
+lrTableView builtinLRTable() {
+    return viewLRTable(builtinLRTableImage, sizeof(builtinLRTableImage));
+}
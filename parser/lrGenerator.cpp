@@ -0,0 +1,355 @@
+#include <bitset>
+#include <optional>
+#include "parser/parser.hpp"
+
+/*
+    LR(1) items are grouped by core, i.e. (rule, position), each with the set of its
+    lookaheads. A state is identified by its kernel: the items with the dot moved past
+    at least one symbol, plus the start item.
+*/
+using lookaheadSet = std::bitset<SYMBOL_COUNT>;
+using itemCore = uint32_t; // rule << 8 | position
+
+static itemCore makeCore(size_t rule, size_t pos) {
+    return itemCore(rule << 8 | pos);
+}
+
+struct lrKernelItem {
+    itemCore core;
+    lookaheadSet lookaheads;
+
+    bool operator==(const lrKernelItem &other) const {
+        return core == other.core && lookaheads == other.lookaheads;
+    }
+};
+
+using lrKernel = std::vector<lrKernelItem>; // sorted by core
+
+struct lrKernelHash {
+    size_t operator()(const lrKernel &kernel) const {
+        size_t hash = kernel.size();
+        for(const auto &item : kernel) {
+            hash = hash * 31 + item.core;
+            hash ^= std::hash<lookaheadSet>()(item.lookaheads) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+struct lrCoresHash {
+    size_t operator()(const std::vector<itemCore> &cores) const {
+        size_t hash = cores.size();
+        for(itemCore core : cores) {
+            hash = hash * 31 + core;
+        }
+        return hash;
+    }
+};
+
+// What the generator needs to know about the grammar, computed once.
+struct grammarIndex {
+    public:
+        grammarIndex(const std::vector<rule> &rules)
+        : rules(rules), rulesOf(SYMBOL_COUNT), first(SYMBOL_COUNT), nullable(SYMBOL_COUNT, false) {
+            // a rule listed more than once is reduced by its last copy, whose action wins
+            std::map<rule, size_t> lastCopy;
+            for(size_t i = 0; i < rules.size(); i++) {
+                if(rules[i].right.size() > 0xff) {
+                    std::cout << "Rule " << i << " is too long for the table generator\n";
+                    exit(1);
+                }
+                lastCopy[rules[i]] = i;
+            }
+            for(size_t i = 0; i < rules.size(); i++) {
+                if(lastCopy[rules[i]] == i) rulesOf[rules[i].left].push_back(i);
+            }
+            // a symbol without productions is a terminal, even if declared as a nonterminal
+            for(size_t sym = 0; sym < SYMBOL_COUNT; sym++) {
+                if(!isNonterminal(symbolType(sym))) first[sym].set(sym);
+            }
+            bool updated = true;
+            while(updated) {
+                updated = false;
+                for(const auto &r : rules) {
+                    lookaheadSet before = first[r.left];
+                    bool allNullable = true;
+                    for(auto sym : r.right) {
+                        first[r.left] |= first[sym];
+                        if(!nullable[sym]) {
+                            allNullable = false;
+                            break;
+                        }
+                    }
+                    if(allNullable && !nullable[r.left]) {
+                        nullable[r.left] = true;
+                        updated = true;
+                    }
+                    updated |= first[r.left] != before;
+                }
+            }
+        }
+
+        bool isNonterminal(symbolType sym) const {
+            return !rulesOf[sym].empty();
+        }
+
+        // FIRST of what follows the dot of (rule, pos), then follow if all of it is nullable.
+        lookaheadSet firstOf(const rule &r, size_t pos, const lookaheadSet &follow) const {
+            lookaheadSet res;
+            for(size_t j = pos; j < r.right.size(); j++) {
+                res |= first[r.right[j]];
+                if(!nullable[r.right[j]]) return res;
+            }
+            return res | follow;
+        }
+
+    public:
+        const std::vector<rule> &rules;
+        std::vector<std::vector<uint32_t>> rulesOf; // by symbol, the rules it is the left side of
+        std::vector<lookaheadSet> first;            // by symbol; a terminal is its own FIRST
+        std::vector<bool> nullable;
+};
+
+// Closes a kernel; the result holds one item per core.
+static lrKernel closure(const grammarIndex &grammar, const lrKernel &kernel) {
+    lrKernel items = kernel;
+    std::unordered_map<itemCore, size_t> indexOf;
+    std::vector<size_t> work;
+    for(size_t i = 0; i < items.size(); i++) {
+        indexOf[items[i].core] = i;
+        work.push_back(i);
+    }
+    while(!work.empty()) {
+        size_t i = work.back();
+        work.pop_back();
+        const rule &r = grammar.rules[items[i].core >> 8];
+        size_t pos = items[i].core & 0xff;
+        if(pos == r.right.size() || !grammar.isNonterminal(r.right[pos])) continue;
+
+        lookaheadSet lookaheads = grammar.firstOf(r, pos + 1, items[i].lookaheads);
+        for(uint32_t k : grammar.rulesOf[r.right[pos]]) {
+            itemCore core = makeCore(k, 0);
+            auto it = indexOf.find(core);
+            if(it == indexOf.end()) {
+                indexOf[core] = items.size();
+                work.push_back(items.size());
+                items.push_back(lrKernelItem{core, lookaheads});
+            } else if((items[it->second].lookaheads | lookaheads) != items[it->second].lookaheads) {
+                items[it->second].lookaheads |= lookaheads;
+                work.push_back(it->second);
+            }
+        }
+    }
+    return items;
+}
+
+LRTable buildLRTable(const std::vector<rule> &rules, lrTableMode mode) {
+    grammarIndex grammar(rules);
+
+    // the one shift/reduce conflict of the grammar: an else binds to the nearest if
+    itemCore danglingElse = ~itemCore(0);
+    for(size_t i = 0; i < rules.size(); i++) {
+        if(rules[i] == rule(Stmt, {KW_IF, LPR, Exp, RPR, Stmt, KW_ELSE, Stmt})) danglingElse = makeCore(i, 5);
+    }
+
+    lookaheadSet eof;
+    eof.set(END_OF_FILE);
+    std::vector<lrKernel> kernels = {lrKernel{lrKernelItem{makeCore(0, 0), eof}}};
+    std::unordered_map<lrKernel, size_t, lrKernelHash> stateOf;           // LR(1)
+    std::unordered_map<std::vector<itemCore>, size_t, lrCoresHash> stateOfCores; // LALR(1)
+    if(mode == LR1_TABLE) {
+        stateOf[kernels[0]] = 0;
+    } else {
+        stateOfCores[{makeCore(0, 0)}] = 0;
+    }
+
+    LRTable table(1);
+    // States are numbered in the order they are found, breadth first with the edges of
+    // a state in symbol order. In LALR mode a state is visited again whenever merging
+    // adds lookaheads to its kernel.
+    std::queue<size_t> work;
+    std::vector<bool> queued = {true};
+    work.push(0);
+    while(!work.empty()) {
+        size_t cur = work.front();
+        work.pop();
+        queued[cur] = false;
+        lrKernel items = closure(grammar, kernels[cur]);
+        std::sort(items.begin(), items.end(), [](const lrKernelItem &a, const lrKernelItem &b) {
+            return a.core < b.core;
+        });
+
+        std::unordered_map<symbolType, action> row;
+        std::map<symbolType, lrKernel> edges;
+        bool hasDanglingElse = false;
+        for(const auto &item : items) {
+            size_t ruleId = item.core >> 8, pos = item.core & 0xff;
+            hasDanglingElse |= item.core == danglingElse;
+            if(pos < rules[ruleId].right.size()) {
+                edges[rules[ruleId].right[pos]].push_back(lrKernelItem{item.core + 1, item.lookaheads});
+                continue;
+            }
+            for(size_t la = 0; la < SYMBOL_COUNT; la++) {
+                if(!item.lookaheads.test(la)) continue;
+                actionType type = ruleId == 0 && la == END_OF_FILE ? ACC : REDUCE;
+                if(!row.insert({symbolType(la), action(type, ruleId)}).second) {
+                    std::cout << "reduce/reduce conflict in state " << cur << " on " << symbolTypeNames.at(symbolType(la))
+                              << " between rules " << row[symbolType(la)].n << " and " << ruleId << "\n";
+                    exit(1);
+                }
+            }
+        }
+
+        for(auto &edge : edges) {
+            lrKernel &kernel = edge.second;
+            std::sort(kernel.begin(), kernel.end(), [](const lrKernelItem &a, const lrKernelItem &b) {
+                return a.core < b.core;
+            });
+            size_t next;
+            if(mode == LR1_TABLE) {
+                auto found = stateOf.find(kernel);
+                if(found == stateOf.end()) {
+                    next = kernels.size();
+                    stateOf[kernel] = next;
+                    kernels.push_back(kernel);
+                }
+                else next = found->second;
+            } else {
+                std::vector<itemCore> cores;
+                for(const auto &item : kernel) cores.push_back(item.core);
+                auto found = stateOfCores.find(cores);
+                if(found == stateOfCores.end()) {
+                    next = kernels.size();
+                    stateOfCores[cores] = next;
+                    kernels.push_back(kernel);
+                } else {
+                    next = found->second;
+                    bool grown = false;
+                    for(size_t i = 0; i < kernel.size(); i++) {
+                        lookaheadSet merged = kernels[next][i].lookaheads | kernel[i].lookaheads;
+                        grown |= merged != kernels[next][i].lookaheads;
+                        kernels[next][i].lookaheads = merged;
+                    }
+                    if(grown && !queued[next]) {
+                        queued[next] = true;
+                        work.push(next);
+                    }
+                }
+            }
+            if(next == table.size()) {
+                table.push_back({});
+                queued.push_back(true);
+                work.push(next);
+            }
+
+            symbolType sym = edge.first;
+            action act(grammar.isNonterminal(sym) ? GOTO : SHIFT, next);
+            if(!row.insert({sym, act}).second) {
+                if(sym != KW_ELSE || !hasDanglingElse) {
+                    std::cout << "shift/reduce conflict in state " << cur << " on " << symbolTypeNames.at(sym) << "\n";
+                    exit(1);
+                }
+                row[sym] = act;
+            }
+        }
+        table[cur] = std::move(row);
+    }
+    return table;
+}
+
+/*
+    Unit rule bypass. When a state q entered on X from p reduces by a unit rule Y -> X on
+    some lookahead, the parser pops q and enters goto(p, Y) without consuming anything,
+    so the action it takes next is the one goto(p, Y) has on that lookahead. The
+    bypassed row for (p, X) is q's row with every such reduction replaced by that
+    action, chained through the unit rules above Y, and with the gotos of the states it
+    stands in for, since later reductions return to it as they would to them. A lookahead
+    goto(p, Y) has no action on stays an error.
+*/
+using lrRow = std::unordered_map<symbolType, action>;
+using lrRowKey = std::vector<std::pair<symbolType, packedAction>>;
+
+static lrRowKey rowKey(const lrRow &row) {
+    lrRowKey key;
+    for(const auto &entry : row) key.push_back({entry.first, packAction(entry.second)});
+    std::sort(key.begin(), key.end());
+    return key;
+}
+
+struct unitBypass {
+    public:
+        // The bypassed row for (state, sym), or nullopt if the gotos it merges disagree.
+        const std::optional<lrRow> &row(size_t state, symbolType sym) {
+            auto key = std::make_pair(state, sym);
+            auto found = memo.find(key);
+            if(found != memo.end()) return found->second;
+            memo[key] = std::nullopt; // a cycle of unit rules is left alone
+
+            const lrRow &target = table[table[state].at(sym).n];
+            lrRow res;
+            std::vector<const lrRow *> outer;
+            for(const auto &entry : target) {
+                const action &a = entry.second;
+                if(a.type != REDUCE || !unitRules[a.n]) {
+                    res.insert(entry);
+                    continue;
+                }
+                const std::optional<lrRow> &up = row(state, rules[a.n].left);
+                if(!up) return memo[key];
+                auto next = up->find(entry.first);
+                if(next != up->end()) res.insert(*next);
+                outer.push_back(&*up);
+            }
+            for(const lrRow *up : outer) {
+                for(const auto &entry : *up) {
+                    if(entry.second.type != GOTO) continue;
+                    auto inserted = res.insert(entry);
+                    if(!inserted.second && inserted.first->second.n != entry.second.n) return memo[key];
+                }
+            }
+            return memo[key] = std::move(res);
+        }
+
+    public:
+        const LRTable &table;
+        const std::vector<rule> &rules;
+        const std::vector<bool> &unitRules;
+        std::map<std::pair<size_t, symbolType>, std::optional<lrRow>> memo;
+};
+
+LRTable bypassUnitRules(const LRTable &table, const std::vector<rule> &rules, const std::vector<bool> &unitRules) {
+    LRTable res = table;
+    std::map<lrRowKey, size_t> stateOfRow;
+    // The gotos of the new states lead to states of the previous round, so rounds go on
+    // until one adds no state.
+    size_t from = 0;
+    while(from < res.size()) {
+        size_t to = res.size();
+        unitBypass bypass{res, rules, unitRules, {}};
+        std::vector<std::tuple<size_t, symbolType, lrRowKey>> edges;
+        for(size_t state = from; state < to; state++) {
+            for(const auto &entry : res[state]) {
+                if(entry.second.type != GOTO) continue;
+                const std::optional<lrRow> &row = bypass.row(state, entry.first);
+                if(!row) continue;
+                lrRowKey key = rowKey(*row);
+                if(key != rowKey(res[entry.second.n])) edges.push_back({state, entry.first, key});
+            }
+        }
+        std::vector<lrRow> added;
+        for(auto &edge : edges) {
+            auto found = stateOfRow.find(std::get<2>(edge));
+            size_t next;
+            if(found == stateOfRow.end()) {
+                next = to + added.size();
+                stateOfRow[std::get<2>(edge)] = next;
+                added.push_back(*bypass.row(std::get<0>(edge), std::get<1>(edge)));
+            }
+            else next = found->second;
+            res[std::get<0>(edge)][std::get<1>(edge)].n = next;
+        }
+        for(auto &row : added) res.push_back(std::move(row));
+        from = to;
+    }
+    return res;
+}
@@ -0,0 +1,353 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include "parser/parser.hpp"
+
+bool lrTableView::lookup(size_t state, symbolType sym, action &a) const {
+    if(sym < firstNonterminal) {
+        packedAction word = actionAt(state, sym);
+        if(word == lrNoAction) return false;
+        a = unpackAction(word);
+    } else {
+        uint32_t target = gotoAt(state, sym);
+        if(target == lrNoAction) return false;
+        a = action(GOTO, target);
+    }
+    return true;
+}
+
+std::string checkLRTable(const void *data, size_t size) {
+    const lrTableHeader *header = (const lrTableHeader *)data;
+    if(size < sizeof(lrTableHeader) || memcmp(header->magic, lrTableMagic, sizeof(lrTableMagic)) != 0) {
+        return "not a binary LR table";
+    }
+    if(header->version != lrTableVersion) {
+        return "table has version " + std::to_string(header->version) + ", expected " + std::to_string(lrTableVersion);
+    }
+    static const uint64_t expectedHash = grammarHash(parserRules);
+    if(header->grammarHash != expectedHash || header->numSymbols != SYMBOL_COUNT
+        || header->numTerminals != firstNonterminal) {
+        return "table was built for another grammar";
+    }
+    if(header->mode != LR1_TABLE && header->mode != LALR1_TABLE) {
+        return "table has an unknown mode " + std::to_string(header->mode);
+    }
+    size_t expected = sizeof(lrTableHeader) + size_t(header->numStates) * header->numSymbols * sizeof(uint32_t);
+    if(size != expected) {
+        return "table is truncated";
+    }
+    return "";
+}
+
+std::string checkLRTable(const void *data, size_t size, lrTableMode mode) {
+    std::string error = checkLRTable(data, size);
+    if(error.empty() && ((const lrTableHeader *)data)->mode != (uint32_t)mode) {
+        return mode == LR1_TABLE ? "table is an LALR(1) table, expected LR(1)" : "table is an LR(1) table, expected LALR(1)";
+    }
+    return error;
+}
+
+lrTableView viewLRTable(const void *data, size_t size) {
+    std::string error = checkLRTable(data, size);
+    if(!error.empty()) {
+        std::cout << "Binary LR table cannot be used: " << error << "; regenerate it\n";
+        exit(1);
+    }
+
+    const lrTableHeader *header = (const lrTableHeader *)data;
+    lrTableView view;
+    view.header = header;
+    view.numTerminals = header->numTerminals;
+    view.numNonterminals = header->numSymbols - header->numTerminals;
+    view.actions = (const packedAction *)(header + 1);
+    view.gotos = view.actions + header->numStates * view.numTerminals;
+    return view;
+}
+
+std::vector<uint32_t> serializeLRTable(const LRTable &table, uint64_t grammar, lrTableMode mode) {
+    const size_t numTerminals = firstNonterminal, numNonterminals = SYMBOL_COUNT - firstNonterminal;
+    std::vector<packedAction> actions(table.size() * numTerminals, lrNoAction);
+    std::vector<uint32_t> gotos(table.size() * numNonterminals, lrNoAction);
+    for(size_t state = 0; state < table.size(); state++) {
+        for(const auto &entry : table[state]) {
+            const action &a = entry.second;
+            if(a.n > lrMaxTarget) {
+                std::cout << "LR table target " << a.n << " does not fit in a packed action\n";
+                exit(1);
+            }
+            if(a.type == GOTO && entry.first < firstNonterminal) {
+                std::cout << "LR table has a GOTO on terminal " << symbolTypeNames.at(entry.first)
+                          << " in state " << state << "\n";
+                exit(1);
+            }
+            if(a.type != GOTO && entry.first >= firstNonterminal) {
+                // a nonterminal without productions (e.g. ConstDecl) is shifted like a
+                // terminal, but no token ever maps to it, so the entry is dead
+                continue;
+            }
+            if(a.type == GOTO) {
+                gotos[state * numNonterminals + (entry.first - firstNonterminal)] = a.n;
+            } else {
+                actions[state * numTerminals + entry.first] = packAction(a);
+            }
+        }
+    }
+
+    lrTableHeader header = {};
+    memcpy(header.magic, lrTableMagic, sizeof(lrTableMagic));
+    header.version = lrTableVersion;
+    header.numStates = table.size();
+    header.numSymbols = SYMBOL_COUNT;
+    header.numTerminals = numTerminals;
+    header.mode = mode;
+    header.grammarHash = grammar;
+
+    std::vector<uint32_t> image(sizeof(header) / sizeof(uint32_t));
+    memcpy(image.data(), &header, sizeof(header));
+    image.insert(image.end(), actions.begin(), actions.end());
+    image.insert(image.end(), gotos.begin(), gotos.end());
+    return image;
+}
+
+size_t compressedLRTable::bytes() const {
+    size_t words = defaultAction.size() + defaultGoto.size() + actionRow.size() + gotoRow.size()
+                 + actions.size() + gotos.size() + actionBase.size() + gotoBase.size()
+                 + actionCheck.size() + gotoCheck.size();
+    return words * sizeof(uint32_t);
+}
+
+using tableRow = std::vector<uint32_t>;
+
+// Stores each row and sets rowOf[state]; rows that are all lrNoAction get noRow, and
+// identical rows are stored once if merge is set.
+static void storeRows(const std::vector<tableRow> &rows, bool merge, std::vector<uint32_t> &rowOf,
+               std::vector<tableRow> &stored) {
+    std::map<tableRow, uint32_t> seen;
+    for(const auto &row : rows) {
+        if(std::all_of(row.begin(), row.end(), [](uint32_t w) { return w == lrNoAction; })) {
+            rowOf.push_back(compressedLRTable::noRow);
+            continue;
+        }
+        if(merge) {
+            auto it = seen.find(row);
+            if(it != seen.end()) {
+                rowOf.push_back(it->second);
+                continue;
+            }
+            seen[row] = stored.size();
+        }
+        rowOf.push_back(stored.size());
+        stored.push_back(row);
+    }
+}
+
+// Row displacement: places the densest rows first, each at the lowest offset where its
+// entries land on free slots. check[slot] holds the row owning the slot.
+static void combRows(const std::vector<tableRow> &rows, std::vector<uint32_t> &values,
+              std::vector<uint32_t> &base, std::vector<uint32_t> &check) {
+    size_t width = rows.empty() ? 0 : rows[0].size();
+    std::vector<uint32_t> order(rows.size());
+    std::vector<size_t> used(rows.size());
+    for(size_t r = 0; r < rows.size(); r++) {
+        order[r] = r;
+        used[r] = std::count_if(rows[r].begin(), rows[r].end(), [](uint32_t w) { return w != lrNoAction; });
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return used[a] > used[b]; });
+
+    base.assign(rows.size(), 0);
+    for(uint32_t r : order) {
+        size_t offset = 0;
+        while(true) {
+            if(values.size() < offset + width) {
+                values.resize(offset + width, lrNoAction);
+                check.resize(offset + width, compressedLRTable::noRow);
+            }
+            bool fits = true;
+            for(size_t col = 0; col < width && fits; col++) {
+                fits = rows[r][col] == lrNoAction || check[offset + col] == compressedLRTable::noRow;
+            }
+            if(fits) break;
+            offset++;
+        }
+        base[r] = offset;
+        for(size_t col = 0; col < width; col++) {
+            if(rows[r][col] == lrNoAction) continue;
+            values[offset + col] = rows[r][col];
+            check[offset + col] = r;
+        }
+    }
+}
+
+compressedLRTable compressLRTable(const lrTableView &table, lrCompression level) {
+    compressedLRTable out;
+    out.level = level;
+    out.numTerminals = table.numTerminals;
+    out.numNonterminals = table.numNonterminals;
+    size_t numStates = table.numStates();
+
+    std::vector<tableRow> actionRows(numStates), gotoRows(numStates);
+    for(size_t state = 0; state < numStates; state++) {
+        actionRows[state].assign(table.actions + state * out.numTerminals, table.actions + (state + 1) * out.numTerminals);
+        gotoRows[state].assign(table.gotos + state * out.numNonterminals, table.gotos + (state + 1) * out.numNonterminals);
+    }
+
+    out.defaultAction.assign(numStates, lrNoAction);
+    out.defaultGoto.assign(out.numNonterminals, lrNoAction);
+    if(level >= LR_DEFAULT_REDUCE) {
+        // the most frequent reduction of each state becomes its default
+        for(size_t state = 0; state < numStates; state++) {
+            std::map<packedAction, size_t> count;
+            for(packedAction word : actionRows[state]) {
+                if(word != lrNoAction && packedType(word) == REDUCE) count[word]++;
+            }
+            if(count.empty()) continue;
+            auto best = std::max_element(count.begin(), count.end(), [](const auto &a, const auto &b) {
+                return a.second < b.second;
+            });
+            out.defaultAction[state] = best->first;
+            for(packedAction &word : actionRows[state]) {
+                if(word == best->first) word = lrNoAction;
+            }
+        }
+        // a goto is only taken where the table has one, so the most frequent target of
+        // each nonterminal can answer for its whole column
+        for(size_t column = 0; column < out.numNonterminals; column++) {
+            std::map<uint32_t, size_t> count;
+            for(size_t state = 0; state < numStates; state++) {
+                if(gotoRows[state][column] != lrNoAction) count[gotoRows[state][column]]++;
+            }
+            if(count.empty()) continue;
+            auto best = std::max_element(count.begin(), count.end(), [](const auto &a, const auto &b) {
+                return a.second < b.second;
+            });
+            out.defaultGoto[column] = best->first;
+            for(size_t state = 0; state < numStates; state++) {
+                if(gotoRows[state][column] == best->first) gotoRows[state][column] = lrNoAction;
+            }
+        }
+    }
+
+    std::vector<tableRow> storedActions, storedGotos;
+    if(level == LR_DENSE) {
+        // every state keeps its own row, even an empty one
+        for(size_t state = 0; state < numStates; state++) {
+            out.actionRow.push_back(state);
+            out.gotoRow.push_back(state);
+        }
+        storedActions = actionRows;
+        storedGotos = gotoRows;
+    } else {
+        storeRows(actionRows, level >= LR_MERGED_ROWS, out.actionRow, storedActions);
+        storeRows(gotoRows, level >= LR_MERGED_ROWS, out.gotoRow, storedGotos);
+    }
+
+    if(level >= LR_COMB) {
+        combRows(storedActions, out.actions, out.actionBase, out.actionCheck);
+        combRows(storedGotos, out.gotos, out.gotoBase, out.gotoCheck);
+    } else {
+        for(const auto &row : storedActions) out.actions.insert(out.actions.end(), row.begin(), row.end());
+        for(const auto &row : storedGotos) out.gotos.insert(out.gotos.end(), row.begin(), row.end());
+    }
+    return out;
+}
+
+uint64_t grammarHash(const std::vector<rule> &rules) {
+    // FNV-1a over every production, with a separator so that rule boundaries count
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint64_t v) {
+        hash ^= v;
+        hash *= 0x100000001b3ull;
+    };
+    mix(SYMBOL_COUNT);
+    for(const auto &r : rules) {
+        mix(r.left);
+        for(auto sym : r.right) {
+            mix(sym);
+        }
+        mix(SYMBOL_COUNT);
+    }
+    return hash;
+}
+
+void exportLRTableToBinary(const LRTable &table, uint64_t grammar, lrTableMode mode, const std::string &filename) {
+    std::vector<uint32_t> image = serializeLRTable(table, grammar, mode);
+    std::ofstream out(filename, std::ios::binary);
+    if(!out.is_open()) {
+        std::cerr << "Failed to create binary table file\n";
+        return;
+    }
+    out.write((const char *)image.data(), image.size() * sizeof(uint32_t));
+    std::cout << "Table saved to " << filename << "\n";
+}
+
+bool mappedLRTable::map(const std::string &filename, void *&addr, size_t &size) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size = st.st_size;
+    addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    return addr != MAP_FAILED;
+}
+
+mappedLRTable::mappedLRTable(const std::string &filename) {
+    if(!map(filename, addr, size)) {
+        std::cout << "Failed to map binary table file " << filename << "\n";
+        exit(1);
+    }
+    view = viewLRTable(addr, size);
+}
+
+mappedLRTable::~mappedLRTable() {
+    munmap(addr, size);
+}
+
+std::string defaultCacheDir() {
+    if(const char *dir = getenv("HDU_CACHE_DIR")) return dir;
+    if(const char *xdg = getenv("XDG_CACHE_HOME")) return std::string(xdg) + "/hdu-compiler";
+    if(const char *home = getenv("HOME")) return std::string(home) + "/.cache/hdu-compiler";
+    return ".hdu-cache";
+}
+
+lrTableCache::lrTableCache(const std::string &dir, lrTableMode mode) {
+    uint64_t hash = grammarHash(parserRules);
+    std::stringstream name;
+    name << dir << "/" << (mode == LR1_TABLE ? "lr1-" : "lalr1-") << std::hex << std::setw(16)
+         << std::setfill('0') << hash << std::dec << "-v" << lrTableVersion << ".bin";
+    path = name.str();
+
+    void *addr;
+    size_t size;
+    hit = mappedLRTable::map(path, addr, size);
+    if(hit) {
+        // a file of the right name can still be corrupt, from a colliding grammar or in the other mode
+        hit = checkLRTable(addr, size, mode).empty();
+        munmap(addr, size);
+    }
+    if(!hit) {
+        built = serializeLRTable(buildLRTable(parserRules, mode), hash, mode);
+        std::error_code error;
+        std::filesystem::create_directories(dir, error);
+        std::string tmp = path + ".tmp" + std::to_string(getpid());
+        std::ofstream out(tmp, std::ios::binary);
+        out.write((const char *)built.data(), built.size() * sizeof(uint32_t));
+        out.close();
+        if(!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            // an unwritable cache only costs the rebuild on every run
+            std::remove(tmp.c_str());
+            table = viewLRTable(built.data(), built.size() * sizeof(uint32_t));
+            return;
+        }
+        built.clear();
+        built.shrink_to_fit();
+    }
+    mapped = std::make_unique<mappedLRTable>(path);
+    table = mapped->view;
+}
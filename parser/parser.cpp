@@ -91,34 +91,34 @@ std::unique_ptr<Base> convert_unique_ptr(std::unique_ptr<Derived> ptr) {
     return std::unique_ptr<Base>(static_cast<Base*>(ptr.release())); // Release and convert
 }
 
-const std::unordered_map<symbolType, std::string> operatorSymbols = {
-    {symbolType::PLUS, "+"},
-    {symbolType::MINUS, "-"},
-    {symbolType::STAR, "*"},
-    {symbolType::SLASH, "/"},
-    {symbolType::PERCENT, "%"},
-    {symbolType::EQ, "=="},
-    {symbolType::NEQ, "!="},
-    {symbolType::LT, "<"},
-    {symbolType::GT, ">"},
-    {symbolType::LTE, "<="},
-    {symbolType::GTE, ">="},
-    {symbolType::AND, "&&"},
-    {symbolType::OR, "||"},
-    {symbolType::NOT, "!"},
-    {symbolType::BIT_AND, "&"},
-    {symbolType::BIT_OR, "|"},
-    {symbolType::BIT_XOR, "^"},
-    {symbolType::SHL, "<<"},
-    {symbolType::SHR, ">>"},
-    {symbolType::ASSIGN, "="},
-    {symbolType::PLUS_EQ, "+="},
-    {symbolType::MINUS_EQ, "-="},
-    {symbolType::STAR_EQ, "*="},
-    {symbolType::SLASH_EQ, "/="},
-    {symbolType::PERCENT_EQ, "%="},
-    {symbolType::PLUS_PLUS, "++"},
-    {symbolType::MINUS_MINUS, "--"},
+const std::unordered_map<symbolType, OpKind> operatorSymbols = {
+    {symbolType::PLUS, Op_Add},
+    {symbolType::MINUS, Op_Sub},
+    {symbolType::STAR, Op_Mul},
+    {symbolType::SLASH, Op_Div},
+    {symbolType::PERCENT, Op_Mod},
+    {symbolType::EQ, Op_Eq},
+    {symbolType::NEQ, Op_Ne},
+    {symbolType::LT, Op_Lt},
+    {symbolType::GT, Op_Gt},
+    {symbolType::LTE, Op_Le},
+    {symbolType::GTE, Op_Ge},
+    {symbolType::AND, Op_And},
+    {symbolType::OR, Op_Or},
+    {symbolType::NOT, Op_Not},
+    {symbolType::BIT_AND, Op_BitAnd},
+    {symbolType::BIT_OR, Op_BitOr},
+    {symbolType::BIT_XOR, Op_BitXor},
+    {symbolType::SHL, Op_Shl},
+    {symbolType::SHR, Op_Shr},
+    {symbolType::ASSIGN, Op_Assign},
+    {symbolType::PLUS_EQ, Op_AddAssign},
+    {symbolType::MINUS_EQ, Op_SubAssign},
+    {symbolType::STAR_EQ, Op_MulAssign},
+    {symbolType::SLASH_EQ, Op_DivAssign},
+    {symbolType::PERCENT_EQ, Op_ModAssign},
+    {symbolType::PLUS_PLUS, Op_Inc},
+    {symbolType::MINUS_MINUS, Op_Dec},
     // ... (extend as needed)
 };
 
@@ -263,7 +263,7 @@ const std::unordered_map<symbolType, std::string> symbolTypeNames = {
 const auto initLoc = std::pair<size_t, size_t>{-1, -1};
 
 SemanticAction binaryFactory() {
-    return [](std::vector<parseInfoPtr>& children) {
+    return [](infoSpan children) {
         // std::cout << "fuck\n";
         auto left = expPtr(static_cast<expr*>(children[0]->ptr.release()));
         auto right = expPtr(static_cast<expr*>(children[2]->ptr.release()));
@@ -276,7 +276,7 @@ SemanticAction binaryFactory() {
 }
 
 SemanticAction unaryFactory() {
-    return [](std::vector<parseInfoPtr>& children) {
+    return [](infoSpan children) {
         auto operand = expPtr(static_cast<expr*>(children[1]->ptr.release()));
         auto ptr = new unary_expr(children[0]->location, operatorSymbols.at(children[0]->kind), 
                                     std::move(operand));
@@ -287,7 +287,7 @@ SemanticAction unaryFactory() {
 }
 
 SemanticAction compUnitFactory() {
-    return [](std::vector<parseInfoPtr> &children) -> parseInfoPtr {
+    return [](infoSpan children) -> parseInfoPtr {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto prog = static_cast<program*>(children[0]->ptr.release());
         prog->children.push_back(children[1]->ptr.release());
@@ -297,7 +297,7 @@ SemanticAction compUnitFactory() {
 }
 
 SemanticAction compUnitFactory_1() {
-    return [](std::vector<parseInfoPtr> &children) -> parseInfoPtr {
+    return [](infoSpan children) -> parseInfoPtr {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto prog = new program(children[0]->location);
         prog->children.push_back(children[0]->ptr.release());
@@ -307,7 +307,7 @@ SemanticAction compUnitFactory_1() {
 }
 
 // SemanticAction funcDefFactory() {
-//     return [](std::vector<parseInfoPtr>& children) {
+//     return [](infoSpan children) {
 //         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
 //         // Create a new function definition with the specified return type and name
@@ -325,7 +325,7 @@ SemanticAction compUnitFactory_1() {
 // }
 
 SemanticAction varDefFactory() {
-    return [](std::vector<parseInfoPtr> &children) -> parseInfoPtr {
+    return [](infoSpan children) -> parseInfoPtr {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto tail = static_cast<var_decl*>(children[2]->ptr.release());
         tail->addVarDef(vardefPtr(static_cast<var_def*>(children[1]->ptr.release())));
@@ -346,16 +346,16 @@ const std::vector<ruleAction> ruleWithAction = {
     ruleAction(rule(CompUnit, {ClassDef}), compUnitFactory_1()),
     ruleAction(rule(CompUnit, {CompUnit, ClassDef}), compUnitFactory()),
 
-    ruleAction(rule(ClassDef, {KW_CLASS, ID, LBC, ClassBody, RBC, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(ClassDef, {KW_CLASS, ID, LBC, ClassBody, RBC, SEMICOLON}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto classDef = static_cast<class_def*>(children[3]->ptr.release());
-        classDef->setName(children[1]->str_val);
+        classDef->setName(children[1]->str_val, children[1]->sym);
         classDef->setLoc(children[0]->location);
         classDef->reverseChildren();
         res->set_node(nodePtr(classDef));
         return res;
     }),
-    ruleAction(rule(ClassBody, {}), [](std::vector<parseInfoPtr>&) {
+    ruleAction(rule(ClassBody, {}), [](infoSpan) {
         parseInfoPtr res = std::make_unique<parseInfo>(initLoc);
         res->set_node(std::make_unique<class_def>(initLoc)); // Empty class_def
         return res;
@@ -364,7 +364,7 @@ const std::vector<ruleAction> ruleWithAction = {
     rule(ClassBody, {ClassMemberList}), // class with members
 
 
-    ruleAction(rule(ClassMemberList, {ClassMember}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(ClassMemberList, {ClassMember}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto def = std::make_unique<class_def>(children[0]->location);
         def->addChild(std::move(children[0]->ptr));
@@ -373,7 +373,7 @@ const std::vector<ruleAction> ruleWithAction = {
     }),
 
     // ClassMemberList → ClassMember ClassMemberList
-    ruleAction(rule(ClassMemberList, {ClassMember, ClassMemberList}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(ClassMemberList, {ClassMember, ClassMemberList}), [](infoSpan children) {
         auto def = static_cast<class_def*>(children[1]->ptr.release());
         def->addChild(std::move(children[0]->ptr));
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
@@ -385,12 +385,13 @@ const std::vector<ruleAction> ruleWithAction = {
     rule(ClassMember, {FuncDef}),       // member function
     rule(ClassMember, {ConstructorDef}), // optional: constructor
 
-    ruleAction(rule(ConstructorDef, {ID, LPR, FuncFParams, RPR, Block}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(ConstructorDef, {ID, LPR, FuncFParams, RPR, Block}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto fun = static_cast<FuncType*>(children[2]->type);
         auto funcDef = new func_def(children[0]->location);
         funcDef->type = fun;
         funcDef->name = children[0]->str_val;
+        funcDef->sym = children[0]->sym;
         funcDef->set_body(blockPtr(static_cast<block_stmt*>(children[4]->ptr.release())));
         funcDef->setCtor();
         
@@ -398,13 +399,14 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),// optional: constructor
 
-    ruleAction(rule(ConstructorDef, {ID, LPR, RPR, Block}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(ConstructorDef, {ID, LPR, RPR, Block}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto funcDef = new func_def(children[0]->location);
         auto fun = new FuncType();
         funcDef->set_body(blockPtr(static_cast<block_stmt*>(children[3]->ptr.release())));
         funcDef->setCtor();
         funcDef->name = children[0]->str_val;
+        funcDef->sym = children[0]->sym;
         funcDef->type = fun;
         res->set_node(nodePtr(funcDef));
         return res;
@@ -417,11 +419,11 @@ const std::vector<ruleAction> ruleWithAction = {
     // Elementary Types
     rule(Type, {KW_INT}),
     rule(Type, {KW_VOID}),
-    ruleAction(rule(Type, {KW_CLASS, ID}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Type, {KW_CLASS, ID}), [](infoSpan children) {
         return std::move(children[1]);
     }), 
     // Constant Declarations
-    // ruleAction(rule(ConstDecl, {KW_CONST, Type, ConstDef, ConstDeclTail, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(ConstDecl, {KW_CONST, Type, ConstDef, ConstDeclTail, SEMICOLON}), [](infoSpan children) {
     //     parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
     //     auto tail = static_cast<var_decl*>(children[3]->ptr.release());
     //     tail->addVarDef(vardefPtr(static_cast<var_def*>(children[2]->ptr.release())));
@@ -432,7 +434,7 @@ const std::vector<ruleAction> ruleWithAction = {
     //     return res;
     // }),
     // ruleAction(rule(ConstDeclTail, {COMMA, ConstDef, ConstDeclTail}), varDefFactory()),
-    // ruleAction(rule(ConstDeclTail, {}), [](std::vector<parseInfoPtr>&) {
+    // ruleAction(rule(ConstDeclTail, {}), [](infoSpan) {
     //     auto res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1});
     //     auto varDecl = std::make_unique<var_decl>(std::pair<size_t, size_t>{-1, -1});
     //     varDecl->setConst(true);
@@ -441,7 +443,7 @@ const std::vector<ruleAction> ruleWithAction = {
     // }),
 
     // // Variable Declarations
-    ruleAction(rule(VarDecl, {Type, VarDef, VarDeclTail, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(VarDecl, {Type, VarDef, VarDeclTail, SEMICOLON}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto tail = static_cast<var_decl*>(children[2]->ptr.release());
         tail->addVarDef(vardefPtr(static_cast<var_def*>(children[1]->ptr.release())));
@@ -452,7 +454,7 @@ const std::vector<ruleAction> ruleWithAction = {
     }),
     ruleAction(rule(VarDeclTail, { COMMA, VarDef, VarDeclTail}), varDefFactory()),
 
-    ruleAction(rule(VarDeclTail, {}), [](std::vector<parseInfoPtr>&) {
+    ruleAction(rule(VarDeclTail, {}), [](infoSpan) {
         auto res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{std::pair<size_t, size_t>{-1, -1}});
         auto varDecl = std::make_unique<var_decl>(std::pair<size_t, size_t>{std::pair<size_t, size_t>{-1, -1}});
         res->set_node(std::move(varDecl));
@@ -460,7 +462,7 @@ const std::vector<ruleAction> ruleWithAction = {
     }),
 
     // Definitions
-    // ruleAction(rule(ConstDef, {ID, ConstDefTail, ASSIGN, ConstInitVal}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(ConstDef, {ID, ConstDefTail, ASSIGN, ConstInitVal}), [](infoSpan children) {
     //     parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
     //     std::string id = children[0]->str_val;
@@ -470,7 +472,7 @@ const std::vector<ruleAction> ruleWithAction = {
     //     res->set_node(nodePtr(arr));
     //     return res;
     // }),
-    // ruleAction(rule(ConstDefTail, {LBK, ConstExp, RBK, ConstDefTail}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(ConstDefTail, {LBK, ConstExp, RBK, ConstDefTail}), [](infoSpan children) {
         
     //     parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
     //     auto tail = static_cast<var_def*>(children[3]->ptr.release());
@@ -480,33 +482,33 @@ const std::vector<ruleAction> ruleWithAction = {
     //     return res;
     // }),
 
-    // ruleAction(rule(ConstDefTail, {}),  [](std::vector<parseInfoPtr>&) {
+    // ruleAction(rule(ConstDefTail, {}),  [](infoSpan) {
     //     auto res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1});
     //     auto varDef = std::make_unique<var_def>(std::pair<size_t, size_t>{-1, -1});
     //     res->set_node(std::move(varDef));
     //     return res;
     // }),
 
-    ruleAction(rule(VarDef, {Declarator}),[](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(VarDef, {Declarator}),[](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         std::string id = children[0]->str_val;
         var_def* arr = new var_def(children[0]->location);
-        arr->setId(id);
+        arr->setId(id, children[0]->sym);
         arr->type = children[0]->type;
         res->set_node(nodePtr(arr));
         return res;
     }),
-    ruleAction(rule(VarDef, {Declarator, ASSIGN, InitVal}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(VarDef, {Declarator, ASSIGN, InitVal}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         std::string id = children[0]->str_val;
         var_def* arr = new var_def(children[0]->location);
-        arr->setId(id);
+        arr->setId(id, children[0]->sym);
         arr->setInitVal(nodePtr(children[2]->ptr.release()));
         arr->type = children[0]->type;
         res->set_node(nodePtr(arr));
         return res;
     }),
-    // ruleAction(rule(VarDefGroup, {LBK, ConstExp, RBK, VarDefGroup}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(VarDefGroup, {LBK, ConstExp, RBK, VarDefGroup}), [](infoSpan children) {
         
     //     parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
     //     auto tail = static_cast<var_def*>(children[3]->ptr.release());
@@ -515,7 +517,7 @@ const std::vector<ruleAction> ruleWithAction = {
     //     res->set_node(nodePtr(tail));
     //     return res;
     // }),
-    // ruleAction(rule(VarDefGroup, {}), [](std::vector<parseInfoPtr>&) {
+    // ruleAction(rule(VarDefGroup, {}), [](infoSpan) {
     //     auto res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1});
     //     auto varDef = std::make_unique<var_def>(std::pair<size_t, size_t>{-1, -1});
     //     res->set_node(std::move(varDef));
@@ -530,7 +532,7 @@ const std::vector<ruleAction> ruleWithAction = {
     // rule(ConstInitValTailTail, {COMMA, ConstInitVal, ConstInitValTailTail}),
     // rule(ConstInitValTailTail, {}),
 
-    ruleAction(rule(InitVal, {Exp}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(InitVal, {Exp}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
         auto val = std::make_unique<init_val>(children[0]->location);
@@ -539,38 +541,39 @@ const std::vector<ruleAction> ruleWithAction = {
         res->set_node(std::move(val));
         return res;
     }),
-    ruleAction(rule(InitVal, {LBC, InitValTail, RBC}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(InitVal, {LBC, InitValTail, RBC}), [](infoSpan children) {
         children[1]->ptr->location = children[0]->location;
         static_cast<init_val*>(children[1]->ptr.get())->reverseChildren();
         return std::move(children[1]);
     }),
-    ruleAction(rule(InitValTail, {InitVal, InitValTailTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(InitValTail, {InitVal, InitValTailTail}), [](infoSpan children) {
         auto container = static_cast<init_val*>(children[1]->ptr.get());
         container->addChild(initValPtr(static_cast<init_val*>(children[0]->ptr.release())));
         return std::move(children[1]);
     }),
-    ruleAction(rule(InitValTail, {}), [](std::vector<parseInfoPtr>&) {
+    ruleAction(rule(InitValTail, {}), [](infoSpan) {
         auto res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1});
         res->set_node(std::make_unique<init_val>(std::pair<size_t, size_t>{-1, -1}));
         return res;
     }),
-    ruleAction(rule(InitValTailTail, {COMMA, InitVal, InitValTailTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(InitValTailTail, {COMMA, InitVal, InitValTailTail}), [](infoSpan children) {
         auto container = static_cast<init_val*>(children[2]->ptr.get());
         init_val *p = static_cast<init_val*>(children[1]->ptr.release());
         p->setLoc(children[0]->location);
         container->addChild(initValPtr(p));
         return std::move(children[2]);
     }),
-    ruleAction(rule(InitValTailTail, {}), [](std::vector<parseInfoPtr>&) {
+    ruleAction(rule(InitValTailTail, {}), [](infoSpan) {
         auto res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1});
         res->set_node(std::unique_ptr<init_val>(new init_val(std::pair<size_t, size_t>{-1, -1})));
         return res;
     }),
 
-    ruleAction(rule(FuncDef, {Type, Declarator, Block}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncDef, {Type, Declarator, Block}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto funcDef = new func_def(children[0]->location);
         funcDef->name = children[1]->str_val;
+        funcDef->sym = children[1]->sym;
         funcDef->set_body(blockPtr(static_cast<block_stmt*>(children[2]->ptr.release())));
         if(children[1]->type == nullptr || children[1]->type->kind != TypeKind::Function) {
             std::cout << "funcdef error, not a function type\n";
@@ -591,7 +594,7 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(Declarator, {STAR, Declarator}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Declarator, {STAR, Declarator}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         res->set_str(children[0]->str_val);
         struct Type *type = children[1]->type;
@@ -630,29 +633,29 @@ const std::vector<ruleAction> ruleWithAction = {
             pointer->depth++;
         }
         res->set_type(children[1]->type);
-        res->set_str(children[1]->str_val);
+        res->set_name(*children[1]);
         return res;
     }),
 
     rule(Declarator, {DirectDeclarator}),
 
-    ruleAction(rule(DirectDeclarator, {SimpleDeclarator, TypeSuffix}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(DirectDeclarator, {SimpleDeclarator, TypeSuffix}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
-        res->set_str(children[0]->str_val);
+        res->set_name(*children[0]);
         res->set_type(children[1]->type);
         return res;
     }),
 
-    ruleAction(rule(DirectDeclarator, {SimpleDeclarator}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(DirectDeclarator, {SimpleDeclarator}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
-        res->set_str(children[0]->str_val);
+        res->set_name(*children[0]);
         res->set_type(nullptr);
         return res;
     }),
 
     rule(TypeSuffix, {TypeDeclIdxTail}),
 
-    ruleAction(rule(TypeDeclIdxTail, {LBK, ConstExp, RBK, TypeDeclIdxTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(TypeDeclIdxTail, {LBK, ConstExp, RBK, TypeDeclIdxTail}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         ArrayType *type = dynamic_cast<ArrayType*>(children[3]->type);
         type->addDim(expPtr(dynamic_cast<expr*>(children[1]->ptr.release())));
@@ -660,7 +663,7 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(TypeDeclIdxTail, {LBK, RBK, TypeDeclIdxTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(TypeDeclIdxTail, {LBK, RBK, TypeDeclIdxTail}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         ArrayType *type = dynamic_cast<ArrayType*>(children[2]->type);
         type->addDim(expPtr(new int_literal(children[0]->location, 0)));
@@ -668,7 +671,7 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(TypeDeclIdxTail, {LBK, ConstExp, RBK}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(TypeDeclIdxTail, {LBK, ConstExp, RBK}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         ArrayType *type = new ArrayType();
         type->addDim(expPtr(dynamic_cast<expr*>(children[1]->ptr.release())));
@@ -676,56 +679,56 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(TypeSuffix, {LPR, FuncFParams, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(TypeSuffix, {LPR, FuncFParams, RPR}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         res->set_type(children[1]->type);
         return res;
     }),
 
-    ruleAction(rule(TypeSuffix, {LPR, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(TypeSuffix, {LPR, RPR}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         FuncType *fun = new FuncType();
         res->set_type(fun);
         return res;
     }),
 
-    ruleAction(rule(FuncFParams, {FuncFParam}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncFParams, {FuncFParam}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         FuncType *fun = new FuncType();
         fun->addArgType(children[0]->type);
-        fun->bindings.push_back(children[0]->str_val);
+        fun->bindings.push_back(children[0]->sym);
         res->set_type(fun);
         return res;
     }),
 
-    ruleAction(rule(FuncFParams, {FuncFParam, FuncFParamsTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncFParams, {FuncFParam, FuncFParamsTail}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         FuncType *fun = dynamic_cast<FuncType*>(children[1]->type);
         fun->addArgType(children[0]->type);
-        fun->bindings.push_back(children[0]->str_val);
+        fun->bindings.push_back(children[0]->sym);
         res->set_type(fun);
         return res;
     }),
 
-    ruleAction(rule(FuncFParamsTail, {COMMA, FuncFParam, FuncFParamsTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncFParamsTail, {COMMA, FuncFParam, FuncFParamsTail}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         FuncType *fun = dynamic_cast<FuncType*>(children[2]->type);
         fun->addArgType(children[1]->type);
-        fun->bindings.push_back(children[1]->str_val);
+        fun->bindings.push_back(children[1]->sym);
         res->set_type(fun);
         return res;
     }),
 
-    ruleAction(rule(FuncFParamsTail, {COMMA, FuncFParam}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncFParamsTail, {COMMA, FuncFParam}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         FuncType *fun = new FuncType();
         fun->addArgType(children[1]->type);
-        fun->bindings.push_back(children[1]->str_val);
+        fun->bindings.push_back(children[1]->sym);
         res->set_type(fun);
         return res;
     }),
 
-    ruleAction(rule(FuncFParam, {Type, Declarator}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncFParam, {Type, Declarator}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         struct Type *result_type = TypeFactory::getTypeFromName(children[0]->str_val);
         if(children[1]->type == nullptr) { //no declarator
@@ -758,14 +761,14 @@ const std::vector<ruleAction> ruleWithAction = {
             dynamic_cast<PointerType*>(children[1]->type)->elementType = result_type;
         }
         res->set_type(children[1]->type);
-        res->str_val = children[1]->str_val;
+        res->set_name(*children[1]);
         return res;
     }),
 
     rule(SimpleDeclarator, {ID}),
 
     // Blocks and Statements
-    ruleAction(rule(Block, {LBC, BlockItemTail, RBC}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Block, {LBC, BlockItemTail, RBC}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
         if (children[1] && children[1]->ptr) {
@@ -780,7 +783,7 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(BlockItemTail, {BlockItem, BlockItemTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(BlockItemTail, {BlockItem, BlockItemTail}), [](infoSpan children) {
         
 
         auto* blk = static_cast<block_stmt*>(children[1]->ptr.get());
@@ -793,7 +796,7 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(BlockItemTail, {}), [](std::vector<parseInfoPtr>&) {
+    ruleAction(rule(BlockItemTail, {}), [](infoSpan) {
         auto res = std::make_unique<parseInfo>(std::pair<size_t,size_t>(0, 0));
         auto blk = std::make_unique<block_stmt>(std::pair<size_t,size_t>(0, 0));
         res->set_node(std::move(blk));
@@ -805,7 +808,7 @@ const std::vector<ruleAction> ruleWithAction = {
 
     // Statements
     // rule(Stmt, {LVal, ASSIGN, Exp, SEMICOLON}),
-    ruleAction(rule(Stmt, {Exp, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {Exp, SEMICOLON}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         expr *ptr = static_cast<expr*>(children[0]->ptr.release());
@@ -816,7 +819,7 @@ const std::vector<ruleAction> ruleWithAction = {
     rule(Stmt, {SEMICOLON}),
     rule(Stmt, {Block}),
     
-    ruleAction(rule(Stmt, {KW_IF, LPR, Exp, RPR, Stmt}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_IF, LPR, Exp, RPR, Stmt}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
@@ -827,7 +830,7 @@ const std::vector<ruleAction> ruleWithAction = {
         res->set_node(nodePtr(node));
         return res;
     }),
-    ruleAction(rule(Stmt, {KW_IF, LPR, Exp, RPR, Stmt, KW_ELSE, Stmt}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_IF, LPR, Exp, RPR, Stmt, KW_ELSE, Stmt}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
@@ -840,7 +843,7 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(Stmt, {KW_WHILE, LPR, Exp, RPR, Stmt}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_WHILE, LPR, Exp, RPR, Stmt}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
 
@@ -851,21 +854,21 @@ const std::vector<ruleAction> ruleWithAction = {
         res->set_node(nodePtr(node));
         return res;
     }),
-    ruleAction(rule(Stmt, {KW_BREAK, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_BREAK, SEMICOLON}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         break_stmt* node = new break_stmt(res->location);
         res->set_node(nodePtr(node));
         return res;
     }),
-    ruleAction(rule(Stmt, {KW_CONTINUE, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_CONTINUE, SEMICOLON}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         continue_stmt* node = new continue_stmt(children[0]->location);
         res->set_node(nodePtr(node));
         return res;
     }),
-    ruleAction(rule(Stmt, {KW_RETURN, Exp, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_RETURN, Exp, SEMICOLON}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         expPtr val = nullptr;
@@ -876,7 +879,7 @@ const std::vector<ruleAction> ruleWithAction = {
         res->set_node(nodePtr(node));
         return res;
     }),
-    ruleAction(rule(Stmt, {KW_RETURN, SEMICOLON}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Stmt, {KW_RETURN, SEMICOLON}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         return_stmt* node = new return_stmt(children[0]->location);
@@ -886,7 +889,7 @@ const std::vector<ruleAction> ruleWithAction = {
 
     // Expressions (from your original set)
     rule(Exp, {LOrExp}),
-    // ruleAction(rule(LVal, {ID, LValTail}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(LVal, {ID, LValTail}), [](infoSpan children) {
         
     //     parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
     //     lval_expr *p = static_cast<lval_expr*>(children[1]->ptr.release());
@@ -895,7 +898,7 @@ const std::vector<ruleAction> ruleWithAction = {
     //     res->set_node(lvalPtr(p));
     //     return res;
     // }),
-    // ruleAction(rule(LValTail, {LBK, Exp, RBK, LValTail}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(LValTail, {LBK, Exp, RBK, LValTail}), [](infoSpan children) {
         
     //     parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
     //     lval_expr *p = static_cast<lval_expr*>(children[3]->ptr.release());
@@ -904,20 +907,20 @@ const std::vector<ruleAction> ruleWithAction = {
     //     res->set_node(nodePtr(p));
     //     return res;
     // }),
-    // ruleAction(rule(LValTail, {}), [](std::vector<parseInfoPtr>& children) {
+    // ruleAction(rule(LValTail, {}), [](infoSpan children) {
     //     parseInfoPtr res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1}); //loc not used
     //     lval_expr *p = new lval_expr();
     //     res->set_node(nodePtr(p));
     //     return res;
     // }),
-    ruleAction(rule(PrimaryExp, {LPR, Exp, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(PrimaryExp, {LPR, Exp, RPR}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         res->set_node(std::move(children[1]->ptr));
         return res;
     }),
     // rule(PrimaryExp, {LVal}),
-    ruleAction(rule(PrimaryExp, {NUM}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(PrimaryExp, {NUM}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         int_literal* ptr = new int_literal(children[0]->location, std::stoul(children[0]->str_val));
@@ -930,14 +933,14 @@ const std::vector<ruleAction> ruleWithAction = {
     rule(UnaryExp, {PrimaryExp}),
 
     // pointer access
-    ruleAction(rule(Exp, {Exp, POINTER_ACC, ID}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Exp, {Exp, POINTER_ACC, ID}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         expr *exp = dynamic_cast<expr*>(children[0]->ptr.release());
         auto ma = new pointer_acc(children[0]->location, expPtr(exp), children[2]->str_val);
         res->set_node(nodePtr(ma));
         return res;
     }),
-    ruleAction(rule(Exp, {Exp, POINTER_ACC, ID, LPR, FuncRParams, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Exp, {Exp, POINTER_ACC, ID, LPR, FuncRParams, RPR}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto obj_expr = expPtr(static_cast<expr*>(children[0]->ptr.release()));
         std::string method_name = children[2]->str_val;
@@ -957,15 +960,15 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(PrimaryExp, {ID}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(PrimaryExp, {ID}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
-        expr *id = new identifier(res->location, children[0]->str_val);
+        expr *id = new identifier(res->location, children[0]->str_val, children[0]->sym);
         res->set_node(nodePtr(id));
         return res;
     }),
 
     // subscript
-    ruleAction(rule(PrimaryExp, {PrimaryExp, LBK, Exp, RBK}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(PrimaryExp, {PrimaryExp, LBK, Exp, RBK}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         expr *list = dynamic_cast<expr*>(children[0]->ptr.release());
         auto sub = new subscript_expr(children[0]->location, expPtr(list), expPtr(dynamic_cast<expr*>(children[2]->ptr.release())));
@@ -974,14 +977,14 @@ const std::vector<ruleAction> ruleWithAction = {
     }),
     
     // member access
-    ruleAction(rule(Exp, {Exp, DOT, ID}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Exp, {Exp, DOT, ID}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         expr *exp = dynamic_cast<expr*>(children[0]->ptr.release());
         auto ma = new member_access(children[0]->location, expPtr(exp), children[2]->str_val);
         res->set_node(nodePtr(ma));
         return res;
     }),
-    ruleAction(rule(Exp, {Exp, DOT, ID, LPR, FuncRParams, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(Exp, {Exp, DOT, ID, LPR, FuncRParams, RPR}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto obj_expr = expPtr(static_cast<expr*>(children[0]->ptr.release()));
         std::string method_name = children[2]->str_val;
@@ -1001,20 +1004,20 @@ const std::vector<ruleAction> ruleWithAction = {
         return res;
     }),
 
-    ruleAction(rule(UnaryExp, {ID, LPR, FuncRParams, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(UnaryExp, {ID, LPR, FuncRParams, RPR}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto tail = static_cast<fun_call*>(children[2]->ptr.release());
-        tail->setName(children[0]->str_val);
+        tail->setName(children[0]->str_val, children[0]->sym);
         tail->setLoc(children[0]->location);
         res->set_node(nodePtr(tail));
         return res;
     }),
-    ruleAction(rule(UnaryExp, {ID, LPR, RPR}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(UnaryExp, {ID, LPR, RPR}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto tail = new fun_call(children[0]->location);
-        tail->setName(children[0]->str_val);
+        tail->setName(children[0]->str_val, children[0]->sym);
         tail->setLoc(children[0]->location);
         res->set_node(nodePtr(tail));
         return res;
@@ -1026,7 +1029,7 @@ const std::vector<ruleAction> ruleWithAction = {
     rule(UnaryOp, {NOT}),
     rule(UnaryOp, {STAR}), //pointer access
 
-    ruleAction(rule(FuncRParams, {Exp, FuncRParamsTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncRParams, {Exp, FuncRParamsTail}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto tail = static_cast<fun_call*>(children[1]->ptr.release());
@@ -1035,7 +1038,7 @@ const std::vector<ruleAction> ruleWithAction = {
         res->set_node(nodePtr(tail));
         return res;
     }), 
-    ruleAction(rule(FuncRParamsTail, {COMMA, Exp, FuncRParamsTail}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncRParamsTail, {COMMA, Exp, FuncRParamsTail}), [](infoSpan children) {
         
         parseInfoPtr res = std::make_unique<parseInfo>(children[0]->location);
         auto tail = static_cast<fun_call*>(children[2]->ptr.release());
@@ -1043,7 +1046,7 @@ const std::vector<ruleAction> ruleWithAction = {
         res->set_node(nodePtr(tail));
         return res;
     }),
-    ruleAction(rule(FuncRParamsTail, {}), [](std::vector<parseInfoPtr>& children) {
+    ruleAction(rule(FuncRParamsTail, {}), [](infoSpan children) {
         parseInfoPtr res = std::make_unique<parseInfo>(std::pair<size_t, size_t>{-1, -1}); //loc not used
         fun_call *p = new fun_call(std::pair<size_t, size_t>{-1, -1});
         res->set_node(nodePtr(p));
@@ -1089,6 +1092,18 @@ std::vector<rule> getBasicRules(const std::vector<ruleAction> &ps) {
 
 const std::vector<rule> parserRules = getBasicRules(ruleWithAction);
 
+std::vector<bool> passThroughUnitRules() {
+    std::set<symbolType> nonterminals;
+    for(const auto &r : parserRules) nonterminals.insert(r.left);
+    std::vector<bool> res(ruleWithAction.size(), false);
+    // rule 0 is accepted, not reduced
+    for(size_t i = 1; i < ruleWithAction.size(); i++) {
+        const rule &r = ruleWithAction[i].rule;
+        res[i] = ruleWithAction[i].action == passFirstChild && r.right.size() == 1 && nonterminals.count(r.right[0]) != 0;
+    }
+    return res;
+}
+
 std::set<symbolType> 
 computeNonterminals(const std::vector<rule> &rules) 
 {
@@ -1259,7 +1274,7 @@ std::set<symbolType>
 computeLookaheads(const rule &rule, size_t pos, symbolType la,
     const firstFollowSet &firstSet)
 {
-    const auto &nonterminals = computeNonterminals(parserRules);
+    static const auto nonterminals = computeNonterminals(parserRules);
     std::set<symbolType> lookaheads;
     for(size_t j = pos; j < rule.right.size() + 1; j++) {//
         if(j == rule.right.size()) {
@@ -1291,7 +1306,7 @@ computeClosure(const std::set<lrItem> &coreItems,
     bool updated = true;
     std::set<lrItem> workingList = coreItems;
     std::set<lrItem> newItems = {};
-    const auto &nonterminals = computeNonterminals(parserRules); 
+    static const auto nonterminals = computeNonterminals(parserRules);
     //Y -> s.Xu (b)  => lookahead is first(ub) for X -> ....
                       
     while(updated) {
@@ -1383,101 +1398,6 @@ computeNextState(lrState state, symbolType edge,
     return lrState(items);
 }
 
-LRTable 
-computeLRTable(
-    const firstFollowSet &firstSet,
-    lrState start)
-{
-    
-    std::vector<lrState> allState = {start};
-    LRTable table; 
-    table.push_back({});
-    std::queue<std::pair<lrState, size_t>> workingQueue;
-    const auto &nonterminals = computeNonterminals(parserRules);
-    workingQueue.push({start, 0});
-    std::map<rule, size_t> ruleToId;
-    
-    for(size_t i = 0; i < parserRules.size(); i++) {
-        ruleToId[parserRules[i]] = i;
-    }
-    while(!workingQueue.empty()) {
-        // std::cout << "HEY" << workingQueue.size() << "\n";
-        const auto &curState = workingQueue.front().first;
-        const size_t curId = workingQueue.front().second;
-        // printLR1Items(curState.items);
-        std::set<symbolType> edges;
-        
-        for(const auto &item : curState.items) {
-            if(item.pos < item.rule.right.size()) {
-                edges.insert(item.rule.right[item.pos]);
-            } else { //reduce
-                if(table[curId].count(item.lookahead) == 0) {
-                    auto startSymbol = parserRules[0].left;
-                    if(item.lookahead != END_OF_FILE || item.rule.left != startSymbol)
-                        table[curId].insert({item.lookahead, action(actionType::REDUCE, ruleToId[item.rule])});
-                    else
-                        table[curId].insert({item.lookahead, action(actionType::ACC, ruleToId[item.rule])});
-                } else {
-                    bool resolved = false;
-
-                    if(!resolved) {
-                        printLR1Items(curState.items);
-                        std::cout << "conflict(1)! entry already exist! \n";
-                        exit(0);
-                    }
-   
-                }
-            }
-        }
-        for(const auto &edge: edges) {
-            const auto &newState = computeNextState(curState, edge, firstSet);
-            bool isNew = true;
-            size_t idx = -1;
-            for(size_t i = 0; i < allState.size(); i++) {
-                if(newState == allState[i]) {
-                    isNew = false;
-                    idx = i;
-                    break;
-                }
-            }
-            if(isNew) {
-                idx = allState.size();
-                allState.push_back(newState);
-                workingQueue.push({newState, idx});
-                table.push_back({});
-            }
-            if(table[curId].count(edge) == 0) {
-                if(nonterminals.count(edge) > 0) { //goto
-                    table[curId].insert({edge, action(actionType::GOTO, idx)});
-                } else { //shift
-                    table[curId].insert({edge, action(actionType::SHIFT, idx)});
-                }
-            } else {
-                bool resolved = false;
-                // printLR1Items(curState.items);
-                for(const auto &item : allState[curId].items) {
-                    if(item.rule == rule(Stmt, {KW_IF, LPR, Exp, RPR, Stmt, KW_ELSE, Stmt}) 
-                        && item.pos == 5 && edge == KW_ELSE) 
-                    {
-                        table[curId][edge] = action(actionType::SHIFT, idx);
-                        resolved = true;
-                        std::cout << "resolved: " << resolved << std::endl;
-                    }
-                }
-                if(!resolved) {
-                    std::cout << "conflict(2)! entry already exist! \n";
-                    exit(0);
-                }
-   
-            }
-        }
-
-        workingQueue.pop();
-    }
-    return table;
-}
-
-
 void exportLRTableToCSV(const LRTable& table, const std::string& filename) {
     std::ofstream csv(filename);
     if (!csv.is_open()) {
@@ -1537,14 +1457,18 @@ void exportLRTableToCSV(const LRTable& table, const std::string& filename) {
     std::cout << "Table saved to " << filename << " (open with Excel)\n";
 }
 
-parseResult
-    Parse(std::vector<token> input, const LRTable &table, bool debug) 
+// The driver is shared by every table form that provides actionAt() and gotoAt().
+template <typename Table>
+static parseResult
+    parseWith(tokenSource &input, const Table &table, bool debug) 
 {   
-    std::vector<symbolType> str;
-    for(const auto &tok : input) {
-        str.push_back(tokenToSymbol(tok.type));
-    }
-    str.push_back(END_OF_FILE); // Add EOF marker
+    // One token of lookahead is all the driver keeps of the input.
+    bool more = input.next();
+    symbolType curSym = more ? tokenToSymbol(input.kind) : END_OF_FILE;
+    std::pair<size_t, size_t> lastLocation; // of the last token shifted, reported at EOF
+    auto curLocation = [&]() {
+        return more ? input.location() : lastLocation;
+    };
     std::vector<size_t> stateStack;
     stateStack.push_back(0); // Initial state
     std::vector<symbolType> symStack;
@@ -1552,16 +1476,9 @@ parseResult
     std::vector<parseInfoPtr> infoStack; 
 
 
-    size_t i = 0; // Input position
     size_t steps = 0;
     while(true) {
         size_t curState = stateStack.back();
-        symbolType curSym = str[i];
-        std::pair<size_t, size_t> location;
-        if(i != input.size())
-            location = input[i].location;
-        else
-            location = input.back().location;
 
         if (debug) {
             std::cout << "\nCurrent State: " << curState 
@@ -1570,33 +1487,29 @@ parseResult
             for (auto s : stateStack) std::cout << s << " ";
             std::cout << "]\nSymbol Stack: [";
             for (auto s : symStack) std::cout << symbolTypeNames.at(s) << " ";
-            std::cout << "]\nRemaining Input: [";
-            for (size_t j = i; j < str.size() && j < i+5; j++)
-                std::cout << symbolTypeNames.at(str[j]) << " ";
-            std::cout << "...]\n";
+            std::cout << "]\nRemaining Input: [" << symbolTypeNames.at(curSym) << " ...]\n";
         }
 
 
-        if(table[curState].count(curSym)) {
-            const action &a = table[curState].at(curSym);
+        packedAction word = table.actionAt(curState, curSym);
+        if(word != lrNoAction) {
+            action a = unpackAction(word);
 
             switch (a.type) {
                 case SHIFT: {
                     if (debug) {
                         std::cout << "ACTION: Shift to state " << a.n 
                                   << " with symbol '" << symbolTypeNames.at(curSym) 
-                                  << " at (" << location.first << ", " << location.second << ")" 
+                                  << " at (" << curLocation().first << ", " << curLocation().second << ")" 
                                   << "'\n";
                     }
-                    auto node = std::make_unique<parseTreeNode>(
-                        curSym
-                    );
+                    lastLocation = input.location();
+                    parseInfoPtr ptr = std::make_unique<parseInfo>(lastLocation);
 
-                    const auto &curTok = input[i];
-
-                    parseInfoPtr ptr = std::make_unique<parseInfo>(curTok.location);
-
-                    ptr->set_str(curTok.value);
+                    ptr->set_str(std::string(input.text()));
+                    if(curSym == ID) {
+                        ptr->sym = Interner::intern(input.text());
+                    }
                     ptr->set_kind(curSym);
                     ptr->set_node(nullptr);
 
@@ -1604,7 +1517,8 @@ parseResult
 
                     stateStack.push_back(a.n);
                     symStack.push_back(curSym);
-                    i++;
+                    more = input.next();
+                    curSym = more ? tokenToSymbol(input.kind) : END_OF_FILE;
                     break;
                 }
                 case REDUCE: {
@@ -1628,25 +1542,15 @@ parseResult
                                 };
                     }
 
-                    // Pop right-hand side
-                    auto parent = std::make_unique<parseTreeNode>(r.left);
-                    std::vector<parseInfoPtr> RHSChildren;
-                    for (size_t j = 0; j < r.right.size(); j++) {
-                        symStack.pop_back();
-                        stateStack.pop_back();
-                        RHSChildren.push_back(std::move(infoStack.back()));
-                        infoStack.pop_back();
-                    }
-
-                    std::reverse(RHSChildren.begin(), RHSChildren.end());
-                    
+                    // The action takes the right-hand side in place, then it is popped
+                    size_t length = r.right.size();
+                    infoSpan rhs{infoStack.data() + infoStack.size() - length, length};
+                    parseInfoPtr lhs = ruleWithAction[a.n].action(rhs);
+                    infoStack.resize(infoStack.size() - length);
+                    symStack.resize(symStack.size() - length);
+                    stateStack.resize(stateStack.size() - length);
+                    infoStack.push_back(std::move(lhs));
 
-                    infoStack.push_back(
-                        ruleWithAction[a.n].action(RHSChildren)
-                        // nullptr
-                    );
-                    
-                    // std::cout << "infoStack size:" << infoStack.size() << std::endl;
                     auto ptr = infoStack.back().get();
                     if(ptr != nullptr && debug) {
                         if(ptr->ptr != nullptr) {
@@ -1654,21 +1558,19 @@ parseResult
                         }
                     }
 
-                    std::reverse(parent->children.begin(), parent->children.end());
-
                     // Push left-hand side
                     symStack.push_back(r.left);
 
                     // Goto new state
                     curState = stateStack.back();
-                    if (table[curState].count(r.left) == 0) {
+                    uint32_t newState = table.gotoAt(curState, r.left);
+                    if (newState == lrNoAction) {
                         std::cerr << "PARSE ERROR: No GOTO for state " << curState 
                                   << " and nonterminal '" << symbolTypeNames.at(r.left) << "'\n";
                         return parseResult{
                                     .node = nullptr
                                 };
                     }
-                    size_t newState = table[curState].at(r.left).n;
                     stateStack.push_back(newState);
 
                     if (debug) {
@@ -1704,7 +1606,7 @@ parseResult
         } else {
             std::cerr << "PARSE ERROR: No action defined for state " << curState 
                       << " and symbol '" << symbolTypeNames.at(curSym) 
-                      << " at (" << location.first << ", " << location.second << ")" 
+                      << " at (" << curLocation().first << ", " << curLocation().second << ")" 
                       << "'\n";
             
             if (debug) {
@@ -1712,10 +1614,7 @@ parseResult
                 for (auto s : stateStack) std::cerr << s << " ";
                 std::cerr << "]\nSymbol Stack: [";
                 for (auto s : symStack) std::cerr << symbolTypeNames.at(s) << " ";
-                std::cerr << "]\nNext 5 Input Symbols: [";
-                for (size_t j = i; j < str.size() && j < i+5; j++)
-                    std::cerr << symbolTypeNames.at(str[j]) << " ";
-                std::cerr << "]\n";
+                std::cerr << "]\nNext Input Symbol: [" << symbolTypeNames.at(curSym) << "]\n";
             }
             
             return parseResult{
@@ -1726,6 +1625,14 @@ parseResult
     }
 }
 
+parseResult Parse(tokenSource &input, const lrTableView &table, bool debug) {
+    return parseWith(input, table, debug);
+}
+
+parseResult Parse(tokenSource &input, const compressedLRTable &table, bool debug) {
+    return parseWith(input, table, debug);
+}
+
 void visualizeAsTree(const parserTreePtr &node, 
                     const std::string& prefix, 
                     bool isLast){
@@ -1,73 +1,131 @@
 #include "symbolTable/symbolTable.hpp"
 
 SymbolTable::SymbolTable() {
-    scopes.push_back({});//the global env
+    slots.resize(64);
 }
-bool SymbolTable::insert(const std::string &symbol, Symbol sym)
+
+// The slot of the symbol, or the empty slot where it would go.
+SymbolTable::slot &SymbolTable::find(symId symbol)
 {
-    auto& table = scopes.back();
-    if (table.find(symbol) != table.end()) {
-        return false; 
+    size_t mask = slots.size() - 1;
+    size_t i = (symbol * 0x9E3779B1u) & mask;
+    while (slots[i].name != 0 && slots[i].name != symbol) {
+        i = (i + 1) & mask;
     }
-    table[symbol] = sym;
-    return true;
+    return slots[i];
 }
 
-bool SymbolTable::exists(const std::string &symbol)
+void SymbolTable::grow()
 {
-    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        if (it->find(symbol) != it->end()) {
-            return true; 
-        }
+    std::vector<slot> old(slots.size() * 2);
+    old.swap(slots);
+    for (const slot &s : old) {
+        if (s.name != 0) find(s.name) = s;
     }
-    return false; 
 }
 
-bool SymbolTable::isInCurrentScope(const std::string& symbol) {
-    if(scopes.back().find(symbol) == scopes.back().end()) return false;
+bool SymbolTable::insert(symId symbol, Symbol sym)
+{
+    // keep the table at most half full
+    if ((names + 1) * 2 > slots.size()) grow();
+    slot &s = find(symbol);
+    if (s.innermost != noBinding && bindings[s.innermost].depth == depth) {
+        return false; 
+    }
+    if (s.name == 0) {
+        s.name = symbol;
+        names++;
+    }
+    bindings.push_back(binding{sym, symbol, depth, s.innermost});
+    s.innermost = bindings.size() - 1;
     return true;
 }
 
-bool SymbolTable::isInGlobal(const std::string &symbol)
+std::optional<Symbol> SymbolTable::lookup(symId symbol)
+{
+    const slot &s = find(symbol);
+    if (s.innermost == noBinding) return std::nullopt;
+    return bindings[s.innermost].sym;
+}
+
+bool SymbolTable::exists(symId symbol)
 {
-    return !(scopes[0].find(symbol) == scopes[0].end());
+    return find(symbol).innermost != noBinding;
+}
+
+bool SymbolTable::isInCurrentScope(symId symbol) {
+    const slot &s = find(symbol);
+    return s.innermost != noBinding && bindings[s.innermost].depth == depth;
 }
 
-Symbol SymbolTable::getFromGlobal(const std::string &symbol)
+bool SymbolTable::isInGlobal(symId symbol)
 {
-    return scopes[0].at(symbol);
+    uint32_t b = find(symbol).innermost;
+    while (b != noBinding && bindings[b].shadowed != noBinding) {
+        b = bindings[b].shadowed;
+    }
+    return b != noBinding && bindings[b].depth == 0;
 }
 
-Symbol SymbolTable::getValue(const std::string &symbol)
+Symbol SymbolTable::getFromGlobal(symId symbol)
 {
-    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        if (it->find(symbol) != it->end()) {
-            return (*it)[symbol]; // Return the symbol's value
-        }
+    uint32_t b = find(symbol).innermost;
+    while (b != noBinding && bindings[b].shadowed != noBinding) {
+        b = bindings[b].shadowed;
+    }
+    if (b == noBinding || bindings[b].depth != 0) {
+        std::cout << "'" << Interner::spelling(symbol) << "' is not in the global scope\n";
+        exit(1);
     }
-    return Symbol{Unknown, nullptr, nullptr};
+    return bindings[b].sym;
+}
+
+Symbol SymbolTable::getValue(symId symbol)
+{
+    return lookup(symbol).value_or(Symbol{Unknown, nullptr, nullptr});
 }
 
 void SymbolTable::beginScope()
 {
     depth++;
     // cout << "enter new scope" << endl;
-    scopes.push_back({});
+    scopeStarts.push_back(bindings.size());
 }
 
 void SymbolTable::endScope()
 {
-    if(depth > 0)
-        depth--;
+    if (scopeStarts.empty()) return;
+    depth--;
     // cout << "quit scope" << endl;
-    if (!scopes.empty()) {
-        scopes.pop_back(); // Remove the current scope
+    // undo the bindings of the scope, innermost first
+    size_t start = scopeStarts.back();
+    scopeStarts.pop_back();
+    while (bindings.size() > start) {
+        const binding &b = bindings.back();
+        find(b.name).innermost = b.shadowed;
+        bindings.pop_back();
+    }
+}
+
+void SymbolTable::insertGlobalsFrom(const SymbolTable &other, size_t count)
+{
+    for (size_t i = bindings.size(); i < count; i++) {
+        insert(other.bindings[i].name, other.bindings[i].sym);
     }
 }
 
-void SymbolTable::printCurScope()
+void SymbolTable::printCurScope(std::ostream &out)
 {
-    for(const auto &sym : scopes.back()) {
-        std::cout << "current scope: " << sym.first + " " << sym.second.type->to_string() << " depth:" << depth << std::endl;
+    size_t start = scopeStarts.empty() ? 0 : scopeStarts.back();
+    for (size_t i = bindings.size(); i > start; i--) {
+        const binding &b = bindings[i - 1];
+        out << "current scope: " << Interner::spelling(b.name) << " " << b.sym.type->to_string() << " depth:" << depth << std::endl;
     }
 }
+
+void SymbolTable::printLastBinding(std::ostream &out)
+{
+    if (bindings.empty()) return;
+    const binding &b = bindings.back();
+    out << "new binding: " << Interner::spelling(b.name) << " " << b.sym.type->to_string() << " depth:" << depth << std::endl;
+}
@@ -0,0 +1,68 @@
+/*
+    Build-time generator of the builtin parse table.
+
+    usage: genLRTable [--lalr] [--bypass-units] <output.inc>
+
+    Computes the LR(1) table of parserRules, or the LALR(1) table with --lalr, optionally
+    with the pass-through unit rules bypassed (see bypassUnitRules), and writes its binary
+    image (see exportLRTableToBinary) as a constexpr array for
+    parser/builtinTable.cpp. The first line of the output records the grammar hash, the
+    table format and the options. If the existing file has the same first line, it is left
+    untouched, so that editing parser.cpp without changing the grammar does not rebuild
+    anything that depends on the table.
+*/
+#include "parser/parser.hpp"
+
+int main(int argc, char *argv[]) {
+    bool lalr = false, bypassUnits = false, usage = argc < 2;
+    for(int i = 1; i < argc - 1; i++) {
+        std::string flag = argv[i];
+        if(flag == "--lalr") lalr = true;
+        else if(flag == "--bypass-units") bypassUnits = true;
+        else usage = true;
+    }
+    if(usage) {
+        std::cout << "usage: " << argv[0] << " [--lalr] [--bypass-units] <output.inc>\n";
+        return 1;
+    }
+    std::string path = argv[argc - 1];
+
+    std::stringstream stamp;
+    stamp << "// grammar " << std::hex << std::setw(16) << std::setfill('0') << grammarHash(parserRules)
+          << " format " << std::dec << lrTableVersion << (lalr ? " lalr1" : " lr1")
+          << (bypassUnits ? " bypass-units" : "");
+    std::ifstream old(path);
+    std::string firstLine;
+    if(old.is_open() && std::getline(old, firstLine) && firstLine == stamp.str()) {
+        std::cout << path << " is up to date\n";
+        return 0;
+    }
+    old.close();
+
+    lrTableMode mode = lalr ? LALR1_TABLE : LR1_TABLE;
+    LRTable table = buildLRTable(parserRules, mode);
+    if(bypassUnits) table = bypassUnitRules(table, parserRules, passThroughUnitRules());
+    std::vector<uint32_t> image = serializeLRTable(table, grammarHash(parserRules), mode);
+
+    // written aside and renamed, so an interrupted run never leaves a stamped partial file
+    std::ofstream out(path + ".tmp");
+    if(!out.is_open()) {
+        std::cout << "Failed to create " << path << "\n";
+        return 1;
+    }
+    out << stamp.str() << "\n"
+        << "// Generated by tools/genLRTable from the grammar in parser/parser.cpp. Do not edit.\n"
+        << "alignas(lrTableHeader) constexpr uint32_t builtinLRTableImage[] = {";
+    for(size_t i = 0; i < image.size(); i++) {
+        out << (i % 12 == 0 ? "\n    " : " ") << "0x" << std::hex << image[i] << std::dec << ",";
+    }
+    out << "\n};\n";
+    out.close();
+    if(std::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+        std::cout << "Failed to replace " << path << "\n";
+        return 1;
+    }
+    std::cout << "Table saved to " << path << " (" << table.size() << " states, "
+              << image.size() * sizeof(uint32_t) << " bytes)\n";
+    return 0;
+}
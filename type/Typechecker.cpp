@@ -1,6 +1,10 @@
 #include "parser/astnodes/node.hpp"
 #include "symbolTable/symbolTable.hpp"
 #include "types/TypeChecker.hpp"
+#include "types/constEval.hpp"
+#include "types/checkCache.hpp"
+#include "parser/astnodes/astCache.hpp"
+#include <thread>
 const analyzeInfo HASERROR = analyzeInfo {
     .type = new ErrorType(),
 };
@@ -8,23 +12,11 @@ const analyzeInfo HASERROR = analyzeInfo {
 void TypeChecker::TypeError(node *ptr, const std::string &str) {
     if(ptr->error_msg == "") {
         ptr->error_msg = color::red + std::string(" error: ") + color::reset + str;
-        std::stringstream ss;
-        if(ptr->location.first - 1 < source.size()) {
-            ss  << "\n"
-                << source[ptr->location.first - 1] // \n is already in the row
-                << std::string(ptr->location.second - 1, ' ') + color::green << "^" << color::reset;
-        } else { //reporting errors
+        if(source == nullptr || ptr->location.first - 1 >= source->lineCount()) { //reporting errors
             std::cout << "TypeError Fault! The location is illegal\n";
             exit(1);
         }
-        const auto &postfix = ss.str();
-        ss.str("");
-        ss  << color::bold_black
-            <<  ":"  
-            <<  ptr->location.first << ":"
-            <<  ptr->location.second << ":"
-            <<  color::reset;
-        errorMessages.push_back(ss.str() + ptr->error_msg + postfix);
+        errorMessages.push_back(typeError{ptr->location, ptr->error_msg});
     }
 }
 
@@ -35,19 +27,24 @@ TypeChecker::TypeChecker()
     currentClassDef = nullptr;
 }
 
+TypeChecker::~TypeChecker()
+{
+    delete symbolTable;
+}
+
 /*
     1. The constructor shouldn't return any value.
     2. 
 
 */
 analyzeInfo TypeChecker::analyze(class_def* node) {
-std::cout << "Entering class: " << node->name << "\n";
-    symbolTable->printCurScope();
+trace() << "Entering class: " << node->name << "\n";
+    symbolTable->printCurScope(trace());
     ClassType *class_ptr = new ClassType(node->name, "");
 
     currentClassDef = node;
 
-    if(symbolTable->isInGlobal(node->name)) {
+    if(symbolTable->isInGlobal(node->sym)) {
         std::stringstream ss;
         ss  << "Class '"
             << node->name
@@ -60,7 +57,7 @@ std::cout << "Entering class: " << node->name << "\n";
         TypeError(node, "'this' cannot be used as a class name");
     }
 
-    symbolTable->insert(node->name, Symbol{.kind = symbolKind::CLASS_DEF,
+    symbolTable->insert(node->sym, Symbol{.kind = symbolKind::CLASS_DEF,
                                         .type = class_ptr,
                                         .data = nullptr});
     node->type = class_ptr;
@@ -88,7 +85,7 @@ std::cout << "Entering class: " << node->name << "\n";
                     });
                 }
         } else {
-            std::cout << node->children[i]->to_string() << "\n";
+            trace() << node->children[i]->to_string() << "\n";
             while(1);
         }
     }
@@ -104,8 +101,8 @@ std::cout << "Entering class: " << node->name << "\n";
             }
         }
     }
-    std::cout << "class scope:\n";
-    symbolTable->printCurScope();
+    trace() << "class scope:\n";
+    symbolTable->printCurScope(trace());
     symbolTable->endScope();
     currentClassDef = nullptr;
     return analyzeInfo();
@@ -124,7 +121,7 @@ void TypeChecker::analyzeAdd(binary_expr *node) {
         node->left = std::move(node->right);
         node->right = std::move(ptr);
         node->inferred_type = node->left->inferred_type;
-    } else if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer && node->op == "-") {
+    } else if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer && node->op == Op_Sub) {
         node->inferred_type = TypeFactory::getInt();
     } 
 }
@@ -152,7 +149,7 @@ void TypeChecker::analyzeCompare(binary_expr *node) {
         node->inferred_type = TypeFactory::getInt();
     }
     if(node->left->inferred_type->kind == TypeKind::Pointer && node->right->inferred_type->kind == TypeKind::Pointer) {
-        if(node->left->inferred_type->equals(node->right->inferred_type)) {
+        if(node->left->inferred_type->sameAs(node->right->inferred_type)) {
             node->inferred_type = TypeFactory::getInt();
         }
     }
@@ -164,12 +161,42 @@ void TypeChecker::analyzeEq(binary_expr *node) {
     } 
 }
 
+const TypeChecker::binaryCheck TypeChecker::binaryChecks[Op_Count] = {
+    /* Op_Add */       &TypeChecker::analyzeAdd,
+    /* Op_Sub */       &TypeChecker::analyzeAdd,
+    /* Op_Mul */       &TypeChecker::analyzeMul,
+    /* Op_Div */       &TypeChecker::analyzeMul,
+    /* Op_Mod */       nullptr,
+    /* Op_Eq */        &TypeChecker::analyzeEq,
+    /* Op_Ne */        &TypeChecker::analyzeEq,
+    /* Op_Lt */        &TypeChecker::analyzeCompare,
+    /* Op_Gt */        &TypeChecker::analyzeCompare,
+    /* Op_Le */        nullptr,
+    /* Op_Ge */        nullptr,
+    /* Op_And */       &TypeChecker::analyzeLogicAnd,
+    /* Op_Or */        &TypeChecker::analyzeLogicAnd,
+    /* Op_Not */       nullptr,
+    /* Op_BitAnd */    &TypeChecker::analyzeBitAnd,
+    /* Op_BitOr */     &TypeChecker::analyzeBitAnd,
+    /* Op_BitXor */    nullptr,
+    /* Op_Shl */       nullptr,
+    /* Op_Shr */       nullptr,
+    /* Op_Assign */    nullptr,
+    /* Op_AddAssign */ nullptr,
+    /* Op_SubAssign */ nullptr,
+    /* Op_MulAssign */ nullptr,
+    /* Op_DivAssign */ nullptr,
+    /* Op_ModAssign */ nullptr,
+    /* Op_Inc */       nullptr,
+    /* Op_Dec */       nullptr
+};
+
 analyzeInfo TypeChecker::analyze(binary_expr* node) {
-    auto info1 = node->left->dispatch(this);
-    auto info2 = node->right->dispatch(this);
+    auto info1 = dispatch(node->left);
+    auto info2 = dispatch(node->right);
     if(info1.type == nullptr || info2.type == nullptr) {
-        std::cout << "binary_expr analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "binary_expr analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
     if(info1.type->kind == TypeKind::Array) {
@@ -180,7 +207,7 @@ analyzeInfo TypeChecker::analyze(binary_expr* node) {
         node->left = expPtr(tc);
         if(array->dims.size() > 1) {
             std::stringstream ss;
-            ss << "Operator '" << node->op << "' cannot apply on type " 
+            ss << "Operator '" << opSpelling(node->op) << "' cannot apply on type " 
             << degrade_array->to_string() 
             << " and " << node->right->inferred_type->to_string() << "";
             TypeError(node, ss.str());
@@ -197,7 +224,7 @@ analyzeInfo TypeChecker::analyze(binary_expr* node) {
         node->right = expPtr(tc);
         if(array->dims.size() > 1) {
             std::stringstream ss;
-            ss << "Operator '" << node->op << "' cannot apply on type " 
+            ss << "Operator '" << opSpelling(node->op) << "' cannot apply on type " 
             << node->left->inferred_type->to_string() 
             << " and " << degrade_array->to_string() << "";
             TypeError(node, ss.str());
@@ -206,35 +233,21 @@ analyzeInfo TypeChecker::analyze(binary_expr* node) {
             node->inferred_type = degrade_array;
         }
     }
-    if(node->op == "+" || node->op == "-") {
-        analyzeAdd(node);
-    }
-    if(node->op == "*" || node->op == "/") {
-        analyzeMul(node);
-    }
-    if(node->op == "&" || node->op == "|") {
-        analyzeBitAnd(node);
-    }
-    if(node->op == "&&" || node->op == "||") {
-        analyzeLogicAnd(node);
-    }
-    if(node->op == ">" || node->op == "<") {
-        analyzeCompare(node);
-    }
-    if(node->op == "==" || node->op == "!=") {
-        analyzeEq(node);
-    }
-    if(node->op == "<=" || node->op == ">=") {
-
+    if(binaryChecks[node->op] != nullptr) {
+        (this->*binaryChecks[node->op])(node);
     }
     if(node->inferred_type == nullptr) {
         node->inferred_type = HASERROR.type;
         std::stringstream ss;
-        ss << "Operator '" << node->op << "' cannot apply on type " 
+        ss << "Operator '" << opSpelling(node->op) << "' cannot apply on type " 
         << info1.type->to_string() 
         << " and " << info2.type->to_string() << "";
         TypeError(node, ss.str());
     }
+    // folded here so that codegen finds the value of constant operations on the node
+    if(node->inferred_type->kind == TypeKind::Int) {
+        constEval(node);
+    }
     return analyzeInfo{
         .type = node->inferred_type
     };
@@ -265,36 +278,34 @@ void TypeChecker::analyzeDeref(unary_expr *node) {
     if(pointer->depth == 1) {
         node->inferred_type = pointer->elementType;
     } else {
-        PointerType *new_pointer = new PointerType();
-        new_pointer->depth = pointer->depth - 1;
-        new_pointer->elementType = pointer->elementType;
-        node->inferred_type = static_cast<Type*>(new_pointer);
+        node->inferred_type = TypeFactory::getPointerTo(pointer->elementType, pointer->depth - 1);
     }
 }
 
 
 analyzeInfo TypeChecker::analyze(unary_expr* node) {
-    auto info = node->operand->dispatch(this);
+    auto info = dispatch(node->operand);
     if(info.type == nullptr) {
-        std::cout << "unary_expr analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "unary_expr analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
-    if(node->op == "*") {
+    if(node->op == Op_Mul) {
         analyzeDeref(node);
         return analyzeInfo{
             .type = node->inferred_type
         };
     }
-    if(!info.type->equals(TypeFactory::getInt())) {
+    if(!info.type->sameAs(TypeFactory::getInt())) {
         std::stringstream ss;
-        ss << "Operator " << node->op << " cannot apply on type " 
+        ss << "Operator " << opSpelling(node->op) << " cannot apply on type " 
            << info.type->to_string() << "";
         TypeError(node, ss.str());
         node->inferred_type = HASERROR.type;
         return HASERROR;
     }
     node->inferred_type = TypeFactory::getInt();
+    constEval(node);
     return analyzeInfo{
         .type = node->inferred_type
     };
@@ -302,15 +313,15 @@ analyzeInfo TypeChecker::analyze(unary_expr* node) {
 
 analyzeInfo TypeChecker::analyze(subscript_expr *node)
 {
-    auto info1 = node->list->dispatch(this);
-    auto info2 = node->sub->dispatch(this);
+    auto info1 = dispatch(node->list);
+    auto info2 = dispatch(node->sub);
 
-    if (info1.type->equals(HASERROR.type) || info2.type->equals(HASERROR.type)) {
+    if (info1.type->sameAs(HASERROR.type) || info2.type->sameAs(HASERROR.type)) {
         node->inferred_type = HASERROR.type;
         return HASERROR;
     }
 
-    if (!info2.type->equals(TypeFactory::getInt())) {
+    if (!info2.type->sameAs(TypeFactory::getInt())) {
         TypeError(node->sub.get(), "Array subscript must be of integer type");
         node->inferred_type = HASERROR.type;
         return HASERROR;
@@ -325,10 +336,7 @@ analyzeInfo TypeChecker::analyze(subscript_expr *node)
             node->inferred_type = ptr->elementType;
             return analyzeInfo{.type = node->inferred_type};
         } else {
-            PointerType *new_ptr = TypeFactory::getPointer();
-            new_ptr->elementType = ptr->elementType;
-            new_ptr->depth = ptr->depth - 1;
-            node->inferred_type = new_ptr;
+            node->inferred_type = TypeFactory::getPointerTo(ptr->elementType, ptr->depth - 1);
             return analyzeInfo{.type = node->inferred_type};
         }
     }
@@ -340,12 +348,8 @@ analyzeInfo TypeChecker::analyze(subscript_expr *node)
             node->inferred_type = arr->element_type;
             return analyzeInfo{.type = node->inferred_type};
         } else {
-            ArrayType *new_arr = dynamic_cast<ArrayType*>(TypeFactory::getArray());
-            new_arr->element_type = arr->element_type;
-            for (size_t i = 1; i < arr->dims.size(); i++) {
-                new_arr->dims.push_back(arr->dims[i]);
-            }
-            node->inferred_type = new_arr;
+            std::vector<size_t> rowDims(arr->dims.begin() + 1, arr->dims.end());
+            node->inferred_type = TypeFactory::getArrayOf(arr->element_type, rowDims);
             return analyzeInfo{.type = node->inferred_type};
         }
     }
@@ -356,13 +360,14 @@ analyzeInfo TypeChecker::analyze(subscript_expr *node)
 
 analyzeInfo TypeChecker::analyze(identifier *node)
 {
-    if(!symbolTable->exists(node->name)) {
+    auto found = symbolTable->lookup(node->sym);
+    if(!found) {
     TypeError(node, "Identifer '" + node->name + "' is not bound");
     node->inferred_type = HASERROR.type;
     return HASERROR;
     } 
-    auto sym = symbolTable->getValue(node->name);
-    if(sym.type->equals(HASERROR.type)) {
+    Symbol sym = *found;
+    if(sym.type->sameAs(HASERROR.type)) {
         TypeError(node, "Identifer '" + node->name + "' is ill-typed");
         node->inferred_type = HASERROR.type;
         return HASERROR;
@@ -497,7 +502,8 @@ analyzeInfo TypeChecker::analyze(identifier *node)
 
 
 analyzeInfo TypeChecker::analyze(fun_call* node) {
-    if(!symbolTable->exists(node->func_name)) {
+    auto found = symbolTable->lookup(node->func_sym);
+    if(!found) {
         std::stringstream ss;
         ss << "Function '" << node->func_name << "' is not bound";
         TypeError(node, ss.str());
@@ -505,14 +511,14 @@ analyzeInfo TypeChecker::analyze(fun_call* node) {
         return HASERROR;
     }
     for(size_t i = 0; i < node->args.size(); i++) {
-        node->args[i]->dispatch(this);
+        dispatch(node->args[i]);
         if(node->args[i]->inferred_type == nullptr) {
-            std::cout << "fun_call analyze fail, the fault is at:\n";
-            node->printAST("","");
+            trace() << "fun_call analyze fail, the fault is at:\n";
+            node->printAST("", "", trace());
             exit(1);
         }
     }
-    auto sym = symbolTable->getValue(node->func_name);
+    Symbol sym = *found;
     if(sym.kind != FUNCTION || sym.type->kind != TypeKind::Function) {
         std::stringstream ss;
         ss  << "'" << node->func_name << "' is of type "
@@ -532,7 +538,7 @@ analyzeInfo TypeChecker::analyze(fun_call* node) {
         return HASERROR;
     }
     for(size_t i = 0; i < std::min(node->args.size(), type->argTypeList.size()); i++) {
-        if(!type->argTypeList[i]->equals(node->args[i]->inferred_type)) {
+        if(!type->argTypeList[i]->sameAs(node->args[i]->inferred_type)) {
             std::stringstream ss;
             ss  << "The " << i << "th argument of function '" << node->func_name 
             << "' is expected to have type "
@@ -566,42 +572,42 @@ analyzeInfo TypeChecker::analyze(int_literal* node) {
 // ========================
 
 analyzeInfo TypeChecker::analyze(expr_stmt* node) {
-    return node->ptr->dispatch(this);
+    return dispatch(node->ptr);
 }
 
 analyzeInfo TypeChecker::analyze(if_else_stmt* node) {
-    auto info1 = node->cond->dispatch(this);
+    auto info1 = dispatch(node->cond);
     if(info1.type == nullptr) {
-        std::cout << "if_else_stmt analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "if_else_stmt analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
     loopDepth++;
-    if(!info1.type->equals(TypeFactory::getInt())) {
+    if(!info1.type->sameAs(TypeFactory::getInt())) {
         std::stringstream ss;
         ss << "The condition is of type " << info1.type->to_string() << ", which is not a numeric type";
         TypeError(node, ss.str());
     }
-    node->if_branch->dispatch(this);
-    if(node->else_branch) node->else_branch->dispatch(this);
+    dispatch(node->if_branch);
+    if(node->else_branch) dispatch(node->else_branch);
     loopDepth--;
     return analyzeInfo();
 }
 
 analyzeInfo TypeChecker::analyze(while_stmt* node) {
-    auto info1 = node->cond->dispatch(this);
+    auto info1 = dispatch(node->cond);
     if(info1.type == nullptr) {
-        std::cout << "while stmt analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "while stmt analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
-    if(!info1.type->equals(TypeFactory::getInt())) {
+    if(!info1.type->sameAs(TypeFactory::getInt())) {
         std::stringstream ss;
         ss << "The condition is of type " << info1.type->to_string() << ", which is not a numeric type";
         TypeError(node, ss.str());
     }
     loopDepth++;
-    node->body->dispatch(this);
+    dispatch(node->body);
     loopDepth--;
     return analyzeInfo();
 }
@@ -622,7 +628,7 @@ analyzeInfo TypeChecker::analyze(continue_stmt* node) {
 
 analyzeInfo TypeChecker::analyze(return_stmt* node) {
     if(node->value == nullptr) {
-        if(!currentFuncDef->is_constructor && !currentFuncDef->type->retType->equals(TypeFactory::getVoid())) {
+        if(!currentFuncDef->is_constructor && !currentFuncDef->type->retType->sameAs(TypeFactory::getVoid())) {
             std::stringstream ss;
             ss  << "The return value should be of type "
                 << currentFuncDef->type->retType->to_string()
@@ -630,32 +636,32 @@ analyzeInfo TypeChecker::analyze(return_stmt* node) {
             TypeError(node, ss.str());
             return analyzeInfo();
         }
-        std::cout << "Type deduction PASS for Return\n";
+        trace() << "Type deduction PASS for Return\n";
         return analyzeInfo();
     }
-    auto info = node->value->dispatch(this);
+    auto info = dispatch(node->value);
     if(info.type == nullptr) {
-        std::cout << "return_stmt analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "return_stmt analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
     if(currentFuncDef->is_constructor) {
         TypeError(node, "The constructor shouldn't return any value");
-    } else if(!currentFuncDef->type->retType->equals(info.type)) {
+    } else if(!currentFuncDef->type->retType->sameAs(info.type)) {
         std::stringstream ss;
         ss << "The return type should be " << currentFuncDef->type->retType->to_string()  
            << ", but the actual type is " << info.type->to_string() << "";
         TypeError(node, ss.str());
         return HASERROR;
     }
-    std::cout << "Type deduction PASS for Return\n";
+    trace() << "Type deduction PASS for Return\n";
     return analyzeInfo();
 }
 
 analyzeInfo TypeChecker::analyze(block_stmt* node) {
     symbolTable->beginScope();
     for(size_t i = 0; i < node->items.size(); i++) {
-        node->items[i]->dispatch(this);
+        dispatch(node->items[i]);
     }
     symbolTable->endScope();
     return analyzeInfo();
@@ -665,29 +671,34 @@ analyzeInfo TypeChecker::analyze(block_stmt* node) {
 // Declaration/Definition Nodes
 // ========================
 
+analyzeInfo TypeChecker::visit(func_def *node) {
+    auto info = analyze(node);
+    analyzeFunctionBody(node);
+    return info;
+}
+
+analyzeInfo TypeChecker::visit(var_def *node) {
+    auto info = analyze(node);
+    analyzeInit(node);
+    return info;
+}
+
 void TypeChecker::analyzeFunctionBody(func_def *node) {
     // symbolTable->printCurScope();
     currentFuncDef = node;
     symbolTable->beginScope();
     if(currentClassDef != 0) {
-        node->type->bindings.insert(node->type->bindings.begin(), "this");
+        node->type->bindings.insert(node->type->bindings.begin(), Interner::intern("this"));
         ClassVarType *cv = TypeFactory::getClassVar(currentClassDef->name);
-        PointerType *pointer = TypeFactory::getPointer();
-        pointer->elementType = cv;
-        node->type->argTypeList.insert(node->type->argTypeList.begin(), pointer);
+        node->type->argTypeList.insert(node->type->argTypeList.begin(), TypeFactory::getPointerTo(cv));
     }
     for(size_t i = 0; i < node->type->argTypeList.size(); i++) {
         if(symbolTable->isInCurrentScope(node->type->bindings[i])) {
             std::stringstream ss;
-            ss  << "'" + node->type->bindings[i] + "'"
+            ss  << "'" << Interner::spelling(node->type->bindings[i]) << "'"
                 << "is redefined\n";
             TypeError(node, ss.str());
         }
-        Type *tmp = node->type->argTypeList[i];
-        if(tmp->kind == TypeKind::Array) {
-            ArrayType *arr = dynamic_cast<ArrayType*>(tmp);
-            node->type->argTypeList[i] = arr->degrade();
-        }
         symbolTable->insert(node->type->bindings[i], 
             Symbol{
                 .kind = VARIABLE,
@@ -697,18 +708,18 @@ void TypeChecker::analyzeFunctionBody(func_def *node) {
     
     bool hasReturnStmt = false;
     for(size_t i = 0; i < node->body.size(); i++) {
-        node->body[i]->printAST("","");
-        node->body[i]->dispatch(this);
+        node->body[i]->printAST("", "", trace());
+        dispatch(node->body[i]);
         if(node->body[i]->kind == ASTKind::Return_Stmt) {
             return_stmt *rt = dynamic_cast<return_stmt*>(node->body[i].get());
             if(rt->value) hasReturnStmt = true;
         }
     }
-    if(node->is_constructor || node->type->retType->equals(TypeFactory::getVoid())) {
+    if(node->is_constructor || node->type->retType->sameAs(TypeFactory::getVoid())) {
         if(hasReturnStmt) {
             TypeError(node, "The constructor shouldn't return any value"); 
         }
-    } else if(!node->type->retType->equals(TypeFactory::getVoid())) {
+    } else if(!node->type->retType->sameAs(TypeFactory::getVoid())) {
         if(!hasReturnStmt) {
             std::stringstream ss;
             ss  << "The return value should be of type "
@@ -723,8 +734,17 @@ void TypeChecker::analyzeFunctionBody(func_def *node) {
 }
 
 analyzeInfo TypeChecker::analyze(func_def* node) {
-    std::cout << "Entering function: " << node->name << "\n";
+    trace() << "Entering function: " << node->name << "\n";
     node->type->evaluate(this);
+    // array parameters decay here rather than with the body, so that callers see the
+    // same parameter types whatever order the bodies are checked in
+    for(size_t i = 0; i < node->type->argTypeList.size(); i++) {
+        Type *tmp = node->type->argTypeList[i];
+        if(tmp->kind == TypeKind::Array) {
+            ArrayType *arr = dynamic_cast<ArrayType*>(tmp);
+            node->type->argTypeList[i] = arr->degrade();
+        }
+    }
 
     // symbolTable->printCurScope();
     if(node->is_constructor && node->name != currentClassDef->name) {
@@ -733,14 +753,14 @@ analyzeInfo TypeChecker::analyze(func_def* node) {
     if(node->name == "this") {
         TypeError(node, "'this' cannot be used as a function name");
     }
-    if(symbolTable->isInCurrentScope(node->name)) {
+    if(symbolTable->isInCurrentScope(node->sym)) {
         std::stringstream ss;
         ss << "Function redefined in the global scope";
         TypeError(node, ss.str());
         return HASERROR;
     }
 
-    symbolTable->insert(node->name, Symbol{.kind = FUNCTION,
+    symbolTable->insert(node->sym, Symbol{.kind = FUNCTION,
                                            .type = node->type,
                                            .data = nullptr});
     return analyzeInfo();
@@ -762,15 +782,15 @@ normalization(init_val *ptr, std::vector<size_t> dims, Type *elementType, TypeCh
 
     for(size_t i = 0; i < ptr->children.size(); i++) {
         init_val *child = ptr->children[i].get();
-         child->printAST("","");
+         child->printAST("", "", tc->trace());
         if(child->scalar) {
-            child->scalar->dispatch(tc); //tc before use inferred type
+            tc->dispatch(child->scalar); //tc before use inferred type
             if(child->scalar->inferred_type == nullptr) {
-                std::cout << "init analyze fail, the fault is at:\n";
-                ptr->printAST("","");
+                tc->trace() << "init analyze fail, the fault is at:\n";
+                ptr->printAST("", "", tc->trace());
                 exit(1);
             }
-            if(elementType->equals(child->scalar->inferred_type)) {
+            if(elementType->sameAs(child->scalar->inferred_type)) {
                    
                 init_val *new_child = new init_val(std::pair<size_t,size_t>(0, 0));
                 
@@ -814,7 +834,7 @@ normalization(init_val *ptr, std::vector<size_t> dims, Type *elementType, TypeCh
     for(size_t i = 0; i < dims.size(); i++) {
         size *= dims[i];
     }
-    std::cout << "SIZE:" << size << "\n";
+    tc->trace() << "SIZE:" << size << "\n";
     if(pos > size) {
         return {result, OVERSIZE};
     }
@@ -822,10 +842,10 @@ normalization(init_val *ptr, std::vector<size_t> dims, Type *elementType, TypeCh
         init_val *new_child = new init_val(std::pair<size_t,size_t>(0, 0));
         int_literal *val = new int_literal(std::pair<size_t,size_t>(0, 0), 0);
         new_child->scalar = expPtr(static_cast<expr*>(val));
-        auto info = new_child->scalar->dispatch(tc);
+        auto info = tc->dispatch(new_child->scalar);
         if(info.type == nullptr) {
-            std::cout << "init analyze fail, the fault is at:\n";
-            new_child->scalar->printAST("","");
+            tc->trace() << "init analyze fail, the fault is at:\n";
+            new_child->scalar->printAST("", "", tc->trace());
             exit(1);
         }
         result->addChild(initValPtr(new_child));
@@ -842,21 +862,21 @@ void TypeChecker::analyzeInit(var_def* node) {
                 ss << "scalar can not be initialzed with a list";
                 TypeError(node, ss.str());
             } else {
-                auto info = p->scalar->dispatch(this);
+                auto info = dispatch(p->scalar);
                 if(info.type == nullptr) {
-                    std::cout << "var_def analyze fail, the fault is at:\n";
-                    node->printAST("","");
+                    trace() << "var_def analyze fail, the fault is at:\n";
+                    node->printAST("", "", trace());
                     exit(1);
                 }
-                if(!info.type->equals(node->type)) {
+                if(!info.type->sameAs(node->type)) {
                     std::stringstream ss;
                     ss << "type mismatch in initialization, "
                        << node->type->to_string() << " is not "
                        << info.type->to_string();
                     TypeError(node, ss.str());
-                } else {
-                    //success
                 }
+                // folded now, so that function bodies only read the result
+                if(node->is_const) constEval(p->scalar.get());
             }
         }
         if(node->type->kind == TypeKind::Array) {
@@ -881,13 +901,13 @@ void TypeChecker::analyzeInit(var_def* node) {
                 }
                 node->init_val = nodePtr(pair.first);
             }
-            std::cout << "HD1A\n";
+            trace() << "HD1A\n";
         }
     }
 }
 
 analyzeInfo TypeChecker::analyze(var_def* node) {
-    if(symbolTable->isInCurrentScope(node->id)) {
+    if(symbolTable->isInCurrentScope(node->sym)) {
         std::stringstream ss;
         ss  << "Variable '"
             << node->id
@@ -899,8 +919,8 @@ analyzeInfo TypeChecker::analyze(var_def* node) {
         TypeError(node, "'this' cannot be explicitly declared as assignable");
         return analyzeInfo();
     }
-    if(node->type->equals(TypeFactory::getVoid())) {
-        std::cout << "Invalid use of type 'void' in variable declaration at (" << node->location.first 
+    if(node->type->sameAs(TypeFactory::getVoid())) {
+        trace() << "Invalid use of type 'void' in variable declaration at (" << node->location.first 
         << "," << node->location.second << ")" << std::endl;
     }
     node->type->evaluate(this);
@@ -920,25 +940,29 @@ analyzeInfo TypeChecker::analyze(var_def* node) {
         return analyzeInfo();
     }
     // std::cout << "vardef:" + node->id + " " + node->type->to_string() << "\n";
-    if(node->is_const) {
-        node->type->setConst();
+    node->type = node->is_const ? TypeFactory::getConst(node->type) : TypeFactory::canonical(node->type);
+
+    // the initializer of a const scalar, which const_eval(identifier*) folds on first use
+    init_val *init = static_cast<init_val*>(node->init_val.get());
+    expr *constInit = node->is_const && node->type->kind != TypeKind::Array && init != nullptr
+        ? init->scalar.get() : nullptr;
+
+    if(node->type) {
+        symbolTable->insert(node->sym, 
+        Symbol{
+            .kind = symbolKind::VARIABLE,
+            .type = node->type,
+            .data = constInit
+        });
+        // not the whole scope, which for globals would be printed again for every one
+        symbolTable->printLastBinding(trace());
     }
-
-    if(node->type)
-
-    symbolTable->insert(node->id, 
-    Symbol{
-        .kind = symbolKind::VARIABLE,
-        .type = node->type,
-        .data = nullptr
-    });
-    symbolTable->printCurScope();
     return analyzeInfo();
 }
 
 analyzeInfo TypeChecker::analyze(var_decl* node) {
     for(size_t i = 0; i < node->defs.size(); i ++) {
-        node->defs[i]->dispatch(this);
+        dispatch(node->defs[i]);
     }
     return analyzeInfo();
 }
@@ -947,13 +971,250 @@ analyzeInfo TypeChecker::analyze(var_decl* node) {
 // Program Node
 // ========================
 
+// Fewer functions than this per thread are not worth one.
+constexpr size_t minFunctionsPerThread = 64;
+
 analyzeInfo TypeChecker::analyze(program* node) {
+    size_t functions = 0;
+    checkCache *incremental = source != nullptr ? cache : nullptr;
     for(size_t i = 0; i < node->children.size(); i++) {
-        node->children[i]->dispatch(this);
+        functions += node->children[i]->kind == ASTKind::Func_Def;
+        if(node->children[i]->kind == ASTKind::Class_Def) incremental = nullptr;
+    }
+    if(incremental) incremental->beginProgram();
+    noteDimensionNames = incremental != nullptr;
+    size_t workers = threads;
+    if(workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::min(workers, functions / minFunctionsPerThread);
+    if(workers > 1) {
+        analyzeParallel(node, workers, incremental);
+    } else {
+        std::shared_ptr<flatAST> saved;   // the nodes of the bodies checked here
+        for(size_t i = 0; i < node->children.size(); i++) {
+            if(incremental && node->children[i]->kind == ASTKind::Func_Def && currentClassDef == nullptr) {
+                func_def *func = static_cast<func_def*>(node->children[i]);
+                analyze(func);
+                std::string key;
+                uint64_t hash = bodyKey(node, i, key);
+                if(reuseBody(func, incremental->find(hash, key))) {
+                    incremental->reused++;
+                } else {
+                    size_t before = errorMessages.size();
+                    analyzeFunctionBody(func);
+                    checkedBody body;
+                    if(saved == nullptr) saved = std::make_shared<flatAST>();
+                    body.key = std::move(key);
+                    body.flat = saved;
+                    saveBody(func, before, saved.get(), body);
+                    incremental->store(hash, std::move(body));
+                    incremental->rechecked++;
+                }
+            } else {
+                dispatch(node->children[i]);
+            }
+        }
     }
+    if(incremental) incremental->endProgram();
     return analyzeInfo();
 }
 
+static uint64_t combineHash(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+static size_t offsetOf(const sourceFile &file, std::pair<size_t, size_t> location) {
+    return file.line(location.first).data() - file.text.data() + location.second - 1;
+}
+
+// The key of the body of the function item of node in a checkCache, put in key, and its
+// hash. The signature must have been checked: its type and the error it gave the
+// definition, which the body check cannot replace, are part of the key.
+uint64_t TypeChecker::bodyKey(program *node, size_t item, std::string &key) {
+    func_def *func = static_cast<func_def*>(node->children[item]);
+    size_t begin = offsetOf(*source, func->location);
+    size_t end = item + 1 < node->children.size()
+        ? offsetOf(*source, node->children[item + 1]->location) : source->text.size();
+    key.assign(source->text, begin, std::max(begin, end) - begin);
+    key += '\0';
+    key += std::to_string(func->location.second);
+    key += '\0';
+    key += func->type->to_string();
+    key += '\0';
+    key += func->error_msg;
+    return sourceHash(key);
+}
+
+// A hash of the global binding of name, 0 if there is none. Called at the global scope.
+uint64_t TypeChecker::globalSignature(symId name) {
+    auto sym = symbolTable->lookup(name);
+    if(!sym) return 0;
+    std::stringstream ss;
+    ss << sym->kind << " " << (sym->type ? sym->type->to_string() : "");
+    if(sym->data != nullptr) {
+        // the initializer of a const scalar, folded when the global was checked
+        const constInfo &value = static_cast<expr*>(sym->data)->constant;
+        ss << " = ";
+        if(!value.is_const) ss << "?";
+        else if(value.value.kind == Const_Float) ss << std::hexfloat << value.value.f;
+        else if(value.value.kind == Const_Char) ss << int(value.value.c);
+        else if(value.value.kind == Const_Bool) ss << value.value.b;
+        else ss << value.value.i;
+    }
+    return combineHash(sourceHash(ss.str()), 1);
+}
+
+// Takes the checked statements and errors of body for node if it was checked with the
+// globals node sees; false if it was not, or body is nullptr.
+bool TypeChecker::reuseBody(func_def *node, checkedBody *body) {
+    if(body == nullptr) return false;
+    for(const auto &[name, signature] : body->globals) {
+        if(globalSignature(name) != signature) return false;
+    }
+    if(body->line != node->location.first) {
+        uint32_t delta = uint32_t(node->location.first - body->line);
+        for(astHandle n = body->begin; n < body->end; n++) {
+            // nodes the parser gave no location keep it
+            uint32_t &line = body->flat->lines[n];
+            if(line != 0 && line != UINT32_MAX) line += delta;
+        }
+        for(auto &error : body->errors) {
+            error.location.first += node->location.first - body->line;
+        }
+        body->line = node->location.first;
+    }
+    node->body.clear();
+    for(astHandle item : body->items) {
+        node->body.push_back(body->flat->toTree(item));
+    }
+    if(node->error_msg.empty()) node->error_msg = body->error_msg;
+    errorMessages.insert(errorMessages.end(), body->errors.begin(), body->errors.end());
+    return true;
+}
+
+// Keeps the checked body of node, whose errors start at firstError, in body. Its nodes
+// are appended to flat, which body must hold. The names the body depends on are those in
+// its nodes and in the dimensions of its arrays, noted while it was checked.
+void TypeChecker::saveBody(func_def *node, size_t firstError, flatAST *flat, checkedBody &body) {
+    body.line = node->location.first;
+    body.begin = flat->size();
+    for(auto &item : node->body) {
+        body.items.push_back(flat->fromTree(item.get()));
+    }
+    body.end = flat->size();
+    body.errors.assign(errorMessages.begin() + firstError, errorMessages.end());
+    // not an error of the signature, which the signature check gives the definition again
+    for(const typeError &error : body.errors) {
+        if(error.location == node->location && error.message == node->error_msg) body.error_msg = error.message;
+    }
+    std::vector<symId> names;
+    names.swap(dimensionNames);
+    for(astHandle n = body.begin; n < body.end; n++) {
+        if(flat->kinds[n] == FLAT_IDENTIFIER || flat->kinds[n] == FLAT_FUN_CALL) {
+            names.push_back(flat->first[n]);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    for(symId name : names) {
+        body.globals.emplace_back(name, globalSignature(name));
+    }
+}
+
+/*
+    Phase one checks the top-level definitions in order as analyze(program*) does, but
+    only the signatures of functions, and notes how many global bindings each function
+    body can see. Phase two checks the bodies on `workers` threads. Each thread has its
+    own checker, with its own scopes, errors and trace stream, which binds the globals a
+    body can see before checking it, and its own astArena for the casts the checker
+    inserts. The errors and the trace of every definition are put back together in source
+    order, so the result is that of a serial check. With a checkCache, the bodies it holds
+    are reused in phase one and the others are kept there after phase two.
+*/
+void TypeChecker::analyzeParallel(program *node, size_t workers, checkCache *incremental) {
+    size_t items = node->children.size();
+    std::vector<std::string> output(items);
+    std::vector<std::vector<typeError>> errors(items);
+    std::vector<size_t> globals(items);
+    std::vector<size_t> bodies;
+    std::vector<uint64_t> hashes(incremental ? items : 0);
+    std::vector<checkedBody> checked(incremental ? items : 0);
+    size_t errorsBefore = errorMessages.size();
+
+    std::ostream *console = traceStream;
+    std::ostringstream itemText;
+    traceStream = &itemText;
+    for(size_t i = 0; i < items; i++) {
+        itemText.str("");
+        size_t before = errorMessages.size();
+        // a function that follows a class whose check stopped early is checked as a
+        // method of it, as the serial check does
+        if(node->children[i]->kind == ASTKind::Func_Def && currentClassDef == nullptr) {
+            func_def *func = static_cast<func_def*>(node->children[i]);
+            analyze(func);
+            if(incremental) hashes[i] = bodyKey(node, i, checked[i].key);
+            if(incremental && reuseBody(func, incremental->find(hashes[i], checked[i].key))) {
+                incremental->reused++;
+            } else {
+                globals[i] = symbolTable->size();
+                bodies.push_back(i);
+            }
+        } else {
+            dispatch(node->children[i]);
+        }
+        output[i] = itemText.str();
+        errors[i].assign(errorMessages.begin() + before, errorMessages.end());
+        errorMessages.resize(before);
+    }
+    traceStream = console;
+
+    std::vector<astArena> arenas(workers);
+    std::vector<std::thread> pool;
+    for(size_t k = 0; k < workers; k++) {
+        pool.emplace_back([&, k] {
+            astArena::scope useArena(arenas[k]);
+            TypeChecker checker;
+            checker.source = source;
+            std::ostringstream bodyText;
+            checker.setTrace(bodyText);
+            checker.noteDimensionNames = incremental != nullptr;
+            std::shared_ptr<flatAST> saved = incremental ? std::make_shared<flatAST>() : nullptr;
+            for(size_t b = bodies.size() * k / workers; b < bodies.size() * (k + 1) / workers; b++) {
+                size_t i = bodies[b];
+                bodyText.str("");
+                checker.symbolTable->insertGlobalsFrom(*symbolTable, globals[i]);
+                checker.analyzeFunctionBody(static_cast<func_def*>(node->children[i]));
+                output[i] += bodyText.str();
+                if(incremental) {
+                    checked[i].flat = saved;
+                    checker.saveBody(static_cast<func_def*>(node->children[i]), 0, saved.get(), checked[i]);
+                }
+                errors[i].insert(errors[i].end(), checker.errorMessages.begin(), checker.errorMessages.end());
+                checker.errorMessages.clear();
+            }
+        });
+    }
+    for(auto &w : pool) {
+        w.join();
+    }
+
+    for(auto &arena : arenas) {
+        astArena::current().adopt(arena);
+    }
+    for(size_t i : bodies) {
+        if(incremental) {
+            incremental->store(hashes[i], std::move(checked[i]));
+            incremental->rechecked++;
+        }
+    }
+    errorMessages.resize(errorsBefore);
+    for(size_t i = 0; i < items; i++) {
+        trace() << output[i];
+        errorMessages.insert(errorMessages.end(), errors[i].begin(), errors[i].end());
+    }
+}
+
 // ========================
 // Initialization Node
 // ========================
@@ -964,10 +1225,10 @@ analyzeInfo TypeChecker::analyze(init_val* node) {
 
 // In this function the visited node will either represent a field or method, indicating by the isFunc
 analyzeInfo TypeChecker::analyze(member_access *node) {
-    auto info = node->exp->dispatch(this);
+    auto info = dispatch(node->exp);
     if(info.type == nullptr) {
-        std::cout << "member_access analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "member_access analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
     if(node->exp->inferred_type->kind != TypeKind::ClassVar) {
@@ -976,13 +1237,13 @@ analyzeInfo TypeChecker::analyze(member_access *node) {
         return HASERROR;
     }
     ClassVarType *classType = dynamic_cast<ClassVarType*>(node->exp->inferred_type);
-    if(!symbolTable->isInGlobal(classType->classname)) {
+    if(!symbolTable->isInGlobal(classType->classSym)) {
         TypeError(node, "The classname '" + classType->classname + "' is not bound");
         node->inferred_type = HASERROR.type;
         return HASERROR;
     }
     
-    auto sym = symbolTable->getFromGlobal(classType->classname);
+    auto sym = symbolTable->getFromGlobal(classType->classSym);
     if(sym.kind != symbolKind::CLASS_DEF) {
         TypeError(node, "The classname '" + classType->classname + "' is not bound to a class");
         node->inferred_type = HASERROR.type;
@@ -1013,13 +1274,13 @@ analyzeInfo TypeChecker::analyze(member_access *node) {
                 TypeError(node, ss.str());
             }
             for(size_t i = 0; i < std::min(node->args.size(), type->argTypeList.size()); i++) {
-                auto info1 = node->args[i]->dispatch(this);
+                auto info1 = dispatch(node->args[i]);
                 if(info1.type == nullptr) {
-                    std::cout << "member_access analyze fail, the fault is at:\n";
-                    node->printAST("","");
+                    trace() << "member_access analyze fail, the fault is at:\n";
+                    node->printAST("", "", trace());
                     exit(1);
                 }
-                if(!type->argTypeList[i]->equals(node->args[i]->inferred_type)) {
+                if(!type->argTypeList[i]->sameAs(node->args[i]->inferred_type)) {
                     std::stringstream ss;
                     ss  << "The " << i << "th argument of function '" << node->name 
                     << "' is expected to have type "
@@ -1050,10 +1311,10 @@ analyzeInfo TypeChecker::analyze(member_access *node) {
 }
 
 analyzeInfo TypeChecker::analyze(pointer_acc *node) {
-    auto info = node->exp->dispatch(this);
+    auto info = dispatch(node->exp);
     if(info.type == nullptr) {
-        std::cout << "point_acc analyze fail, the fault is at:\n";
-        node->printAST("","");
+        trace() << "point_acc analyze fail, the fault is at:\n";
+        node->printAST("", "", trace());
         exit(1);
     }
     if(node->exp->inferred_type->kind != TypeKind::Pointer) {
@@ -1063,7 +1324,7 @@ analyzeInfo TypeChecker::analyze(pointer_acc *node) {
     }
     PointerType *pointer = dynamic_cast<PointerType*>(node->exp->inferred_type);
     if(pointer->elementType == nullptr) {
-        std::cout << "In analyze pointer_acc, pointer->elementtype is nullpointer\n";
+        trace() << "In analyze pointer_acc, pointer->elementtype is nullpointer\n";
         exit(1);
     }
     if(!(pointer->elementType->kind == TypeKind::ClassVar)) {
@@ -1073,12 +1334,12 @@ analyzeInfo TypeChecker::analyze(pointer_acc *node) {
     }
 
     ClassVarType *classType = dynamic_cast<ClassVarType*>(pointer->elementType);
-    if(!symbolTable->isInGlobal(classType->classname)) {
+    if(!symbolTable->isInGlobal(classType->classSym)) {
         TypeError(node, "The classname '" + classType->classname + "' is not bound");
         node->inferred_type = HASERROR.type;
         return HASERROR;
     }
-    auto sym = symbolTable->getFromGlobal(classType->classname);
+    auto sym = symbolTable->getFromGlobal(classType->classSym);
     if(sym.kind != symbolKind::CLASS_DEF) {
         TypeError(node, "The classname '" + classType->classname + "' is not bound to a class");
         node->inferred_type = HASERROR.type;
@@ -1092,7 +1353,7 @@ analyzeInfo TypeChecker::analyze(pointer_acc *node) {
             node->inferred_type = HASERROR.type;
             return HASERROR;
         } else {
-            std::cout << classType->classname << "\n";
+            trace() << classType->classname << "\n";
             if(node->name == classType->classname) {
                 TypeError(node, "Constructor cannot be called using pointer");
                 node->inferred_type = HASERROR.type;
@@ -1110,13 +1371,13 @@ analyzeInfo TypeChecker::analyze(pointer_acc *node) {
                 TypeError(node, ss.str());
             }
             for(size_t i = 0; i < std::min(node->args.size(), type->argTypeList.size()); i++) {
-                auto info2 = node->args[i]->dispatch(this);
+                auto info2 = dispatch(node->args[i]);
                 if(info2.type == nullptr) {
-                    std::cout << "pointer_acc analyze fail, the fault is at:\n";
-                    node->printAST("","");
+                    trace() << "pointer_acc analyze fail, the fault is at:\n";
+                    node->printAST("", "", trace());
                     exit(1);
                 }
-                if(!type->argTypeList[i]->equals(node->args[i]->inferred_type)) {
+                if(!type->argTypeList[i]->sameAs(node->args[i]->inferred_type)) {
                     std::stringstream ss;
                     ss  << "The " << i << "th argument of function '" << node->name 
                     << "' is expected to have type "
@@ -1154,22 +1415,23 @@ analyzeInfo TypeChecker::evaluate(ArrayType *node)
         if (node->pendingDims[size - i - 1]) {
             // evaluate pending dims into constants
             expr *p = node->pendingDims[size - i - 1].get();
-            auto info1 = p->dispatch(this);//typecheck before const_eval!
+            auto info1 = dispatch(p);//typecheck before const_eval!
             if(info1.type == nullptr) {
-                std::cout << "array_type analyze fail, the fault is at:\n";
-                node->printUnevaludatedType("","");
+                trace() << "array_type analyze fail, the fault is at:\n";
+                node->printUnevaludatedType("", "", trace());
                 exit(1);
             }
-            if(!info1.type->equals(TypeFactory::getInt()) && !node->hasError) {
+            if(!info1.type->sameAs(TypeFactory::getInt()) && !node->hasError) {
                 node->hasError = true;
                 std::stringstream ss;
                 ss << "The " << i << "th index of array type is not of integer type";
                 node->errorMsgs.push_back(ss.str());
             }
-            constInfo info = p->const_eval(this);
+            constInfo info = constEval(p);
             if(info.is_const) {
-                if(info.type->equals(TypeFactory::getInt())) {
-                    node->dims.push_back(*(int*)info.value);
+                if(info.value.kind == Const_Int) {
+                    // a dim that is not positive is reported by the definition
+                    node->dims.push_back(info.value.i > 0 ? info.value.i : 0);
                 }
             } else {
                 node->dims.push_back(0);
@@ -1185,6 +1447,17 @@ analyzeInfo TypeChecker::evaluate(ArrayType *node)
             node->dims.push_back(0);
         }
     }
+    if(noteDimensionNames && currentFuncDef != nullptr) {
+        for(auto &dim : node->pendingDims) {
+            flatAST flat;
+            flat.fromTree(dim.get());
+            for(astHandle n = 0; n < flat.size(); n++) {
+                if(flat.kinds[n] == FLAT_IDENTIFIER || flat.kinds[n] == FLAT_FUN_CALL) {
+                    dimensionNames.push_back(flat.first[n]);
+                }
+            }
+        }
+    }
     node->pendingDims.clear();
     return analyzeInfo();
 }
@@ -1193,18 +1466,62 @@ analyzeInfo TypeChecker::evaluate(FuncType *node)
 {
     for(size_t i = 0; i < node->argTypeList.size(); i++) {
         node->argTypeList[i]->evaluate(this);
+        if(!node->argTypeList[i]->hasError) {
+            node->argTypeList[i] = TypeFactory::canonical(node->argTypeList[i]);
+        }
     }
+    node->retType = TypeFactory::canonical(node->retType);
     return analyzeInfo();
 }
 
-constInfo TypeChecker::const_eval(unary_expr *ptr)
+constInfo TypeChecker::constEval(expr *node)
+{
+    if(!node->const_evaluated) {
+        // marked first, so that a constant whose initializer refers to itself is not one
+        node->const_evaluated = true;
+        node->constant = node->const_eval(this);
+    }
+    return node->constant;
+}
+
+static constInfo folded(std::optional<constValue> value)
+{
+    if(!value) return constInfo();
+    return constInfo{
+        .is_const = true,
+        .value = *value,
+        .type = constantType(*value)
+    };
+}
+
+constInfo TypeChecker::const_eval(unary_expr *node)
 {
-    return constInfo();
+    if(node->inferred_type == nullptr || node->inferred_type->kind == TypeKind::Error) {
+        return constInfo();
+    }
+    constInfo operand = constEval(node->operand.get());
+    if(!operand.is_const) return constInfo();
+    return folded(foldUnary(node->op, operand.value));
 }
 
 constInfo TypeChecker::const_eval(binary_expr *node)
 {
-    return constInfo();
+    if(node->inferred_type == nullptr || node->inferred_type->kind == TypeKind::Error) {
+        return constInfo();
+    }
+    constInfo left = constEval(node->left.get());
+    if(!left.is_const) return constInfo();
+    constInfo right = constEval(node->right.get());
+    if(!right.is_const) return constInfo();
+    return folded(foldBinary(node->op, left.value, right.value));
+}
+
+constInfo TypeChecker::const_eval(identifier *node)
+{
+    // a const scalar variable keeps its initializer in the symbol's data
+    auto sym = symbolTable->lookup(node->sym);
+    if(!sym || sym->kind != VARIABLE || sym->data == nullptr) return constInfo();
+    return constEval(static_cast<expr*>(sym->data));
 }
 
 // constInfo TypeChecker::const_eval(lval_expr *node)
@@ -1235,7 +1552,7 @@ constInfo TypeChecker::const_eval(fun_call *node)
 {
     return constInfo {
         .is_const = false,
-        .value = nullptr,
+        .value = {},
         .type = HASERROR.type
     };
 }
@@ -1246,14 +1563,20 @@ constInfo TypeChecker::const_eval(int_literal *node)
     node->inferred_type = TypeFactory::getInt();
     return constInfo{
         .is_const = true,
-        .value = (void*)(new int(node->value)),
+        .value = intConstant(node->value),
         .type = node->inferred_type
     };
 }
 
-void TypeChecker::dumpErrors(std::string path) {
-    for(const auto &str : errorMessages) {
-        std::cout << color::bold_black << path << color::reset << str << std::endl;
+void TypeChecker::dumpErrors(std::string_view path) {
+    for(const auto &error : errorMessages) {
+        std::string_view row = source->line(error.location.first);
+        std::cout << color::bold_black << path << color::reset
+                  << color::bold_black << ":" << error.location.first << ":" << error.location.second << ":"
+                  << color::reset << error.message << "\n"
+                  << row << (row.empty() || row.back() != '\n' ? "\n" : "")
+                  << std::string(error.location.second - 1, ' ') << color::green << "^" << color::reset
+                  << std::endl;
     }
 }
 
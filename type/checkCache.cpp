@@ -0,0 +1,27 @@
+#include "types/checkCache.hpp"
+
+checkedBody *checkCache::find(uint64_t hash, const std::string &key) {
+    auto found = entries.find(hash);
+    if(found == entries.end() || found->second.key != key) return nullptr;
+    found->second.used = true;
+    return &found->second;
+}
+
+void checkCache::store(uint64_t hash, checkedBody body) {
+    body.used = true;
+    entries[hash] = std::move(body);
+}
+
+void checkCache::beginProgram() {
+    reused = rechecked = 0;
+    for(auto &[key, body] : entries) {
+        body.used = false;
+    }
+}
+
+void checkCache::endProgram() {
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(it->second.used) ++it;
+        else it = entries.erase(it);
+    }
+}
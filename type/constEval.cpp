@@ -0,0 +1,112 @@
+#include <climits>
+#include "types/constEval.hpp"
+
+constValue intConstant(int32_t value) {
+    constValue res;
+    res.kind = Const_Int;
+    res.i = value;
+    return res;
+}
+
+constValue floatConstant(float value) {
+    constValue res;
+    res.kind = Const_Float;
+    res.f = value;
+    return res;
+}
+
+struct Type *constantType(const constValue &value) {
+    switch(value.kind) {
+        case Const_Char: return TypeFactory::getChar();
+        case Const_Float: return TypeFactory::getFloat();
+        case Const_Bool: return TypeFactory::getBool();
+        default: return TypeFactory::getInt();
+    }
+}
+
+// The value after the integer promotions.
+static int32_t asInt(const constValue &value) {
+    switch(value.kind) {
+        case Const_Char: return value.c;
+        case Const_Bool: return value.b;
+        case Const_Float: return (int32_t)value.f;
+        default: return value.i;
+    }
+}
+
+static float asFloat(const constValue &value) {
+    return value.kind == Const_Float ? value.f : (float)asInt(value);
+}
+
+static bool isTrue(const constValue &value) {
+    return value.kind == Const_Float ? value.f != 0 : asInt(value) != 0;
+}
+
+// Two's complement arithmetic at 32 bits, done unsigned so that it wraps.
+static int32_t wrap(uint32_t value) {
+    return (int32_t)value;
+}
+
+std::optional<constValue> foldUnary(OpKind op, constValue operand) {
+    bool isFloat = operand.kind == Const_Float;
+    switch(op) {
+        case Op_Add:
+            return isFloat ? operand : intConstant(asInt(operand));
+        case Op_Sub:
+            return isFloat ? floatConstant(-operand.f) : intConstant(wrap(0u - (uint32_t)asInt(operand)));
+        case Op_Not:
+            return intConstant(!isTrue(operand));
+        default:
+            return std::nullopt;
+    }
+}
+
+std::optional<constValue> foldBinary(OpKind op, constValue left, constValue right) {
+    if(op == Op_And) return intConstant(isTrue(left) && isTrue(right));
+    if(op == Op_Or) return intConstant(isTrue(left) || isTrue(right));
+
+    if(left.kind == Const_Float || right.kind == Const_Float) {
+        float l = asFloat(left), r = asFloat(right);
+        switch(op) {
+            case Op_Add: return floatConstant(l + r);
+            case Op_Sub: return floatConstant(l - r);
+            case Op_Mul: return floatConstant(l * r);
+            case Op_Div: return floatConstant(l / r);
+            case Op_Eq: return intConstant(l == r);
+            case Op_Ne: return intConstant(l != r);
+            case Op_Lt: return intConstant(l < r);
+            case Op_Gt: return intConstant(l > r);
+            case Op_Le: return intConstant(l <= r);
+            case Op_Ge: return intConstant(l >= r);
+            default: return std::nullopt;
+        }
+    }
+
+    int32_t l = asInt(left), r = asInt(right);
+    uint32_t ul = (uint32_t)l, ur = (uint32_t)r;
+    switch(op) {
+        case Op_Add: return intConstant(wrap(ul + ur));
+        case Op_Sub: return intConstant(wrap(ul - ur));
+        case Op_Mul: return intConstant(wrap(ul * ur));
+        case Op_Div:
+        case Op_Mod:
+            if(r == 0 || (l == INT32_MIN && r == -1)) return std::nullopt;
+            return intConstant(op == Op_Div ? l / r : l % r);
+        case Op_Eq: return intConstant(l == r);
+        case Op_Ne: return intConstant(l != r);
+        case Op_Lt: return intConstant(l < r);
+        case Op_Gt: return intConstant(l > r);
+        case Op_Le: return intConstant(l <= r);
+        case Op_Ge: return intConstant(l >= r);
+        case Op_BitAnd: return intConstant(l & r);
+        case Op_BitOr: return intConstant(l | r);
+        case Op_BitXor: return intConstant(l ^ r);
+        case Op_Shl:
+        case Op_Shr:
+            if(r < 0 || r >= 32) return std::nullopt;
+            // >> is an arithmetic shift on int
+            return intConstant(op == Op_Shl ? wrap(ul << r) : l >> r);
+        default:
+            return std::nullopt;
+    }
+}
@@ -93,44 +93,30 @@ std::string ArrayType::to_string() {
 Type *ArrayType::degrade()
 {
     if(dims.size() > 1) {
-        PointerType *result = new PointerType();
-        ArrayType *array = new ArrayType();
-        for(int i = 1; i < dims.size(); i++) {
-            array->dims.push_back(dims[i]);
-        }
-        array->element_type = this->element_type;
-        result->elementType = array;
-        return result;
-    } else {
-        if(element_type->kind != TypeKind::Pointer) {
-            PointerType *target = new PointerType();
-            target->elementType = element_type;
-            return target;
-        } else {
-            PointerType *p = dynamic_cast<PointerType*>(element_type);
-            p->depth++;
-            return p;
-        }
+        std::vector<size_t> rowDims(dims.begin() + 1, dims.end());
+        return TypeFactory::getPointerTo(TypeFactory::getArrayOf(element_type, rowDims));
     }
+    // an array of pointers decays to a pointer one level deeper
+    return TypeFactory::getPointerTo(element_type);
 }
 
-void ArrayType::printUnevaludatedType(std::string prefix, std::string info_prefix)
+void ArrayType::printUnevaludatedType(std::string prefix, std::string info_prefix, std::ostream &out)
 {
-    std::cout << info_prefix << to_string() << "\n";
+    out << info_prefix << to_string() << "\n";
     for (size_t i = 0; i < pendingDims.size(); ++i) {
         expr *p = pendingDims[pendingDims.size() - i - 1].get();
         if (i != pendingDims.size() - 1) {
             if(p == nullptr) {
-                std::cout << prefix + "├── " << "uncomplete\n";
+                out << prefix + "├── " << "uncomplete\n";
                 continue;
             }
-            p->printAST(prefix + "│   ", prefix + "├── ");
+            p->printAST(prefix + "│   ", prefix + "├── ", out);
         } else {
             if(p == nullptr) {
-                std::cout << prefix + "└── " << " uncomplete\n";
+                out << prefix + "└── " << " uncomplete\n";
                 continue;
             }
-            p->printAST(prefix + "    ", prefix + "└── ");
+            p->printAST(prefix + "    ", prefix + "└── ", out);
         }
     }
 }
@@ -282,12 +268,13 @@ void ClassType::setConst()
 ClassVarType::ClassVarType(const std::string &classname) 
 : Type(TypeKind::ClassVar){
     this->classname = classname;
+    this->classSym = Interner::intern(classname);
     is_const = false;
 }
 
 bool ClassVarType::equals(Type* other) {
     if(this->kind != other->kind) return false;
-    if(this->classname != ((ClassVarType*)other)->classname) return false;
+    if(this->classSym != ((ClassVarType*)other)->classSym) return false;
     return true;
 }
 
@@ -316,7 +303,7 @@ Type *TypeFactory::getTypeFromName(const std::string& type_name) {
 
     auto it = type_map.find(type_name);
     if (it == type_map.end()) { // classVarType
-        return static_cast<Type*>(new ClassVarType(type_name));
+        return TypeFactory::getClassVar(type_name);
     }
 
     Type *type;
@@ -343,74 +330,298 @@ Type *TypeFactory::getTypeFromName(const std::string& type_name) {
     return type;
 }
 
+// The primitive types are built on first use and never change.
+static Type *makePrimitive(TypeKind kind, size_t size) {
+    Type *type = new PrimitiveType(kind, size);
+    type->unqualified = type;
+    return type;
+}
+
 Type *TypeFactory::getVoid() { 
-    return makePrimitive(TypeKind::Void, 0); 
+    static Type *const type = makePrimitive(TypeKind::Void, 0);
+    return type;
 }
 
 Type *TypeFactory::getInt() { 
-    return makePrimitive(TypeKind::Int, 4); 
+    static Type *const type = makePrimitive(TypeKind::Int, 4);
+    return type;
 }
 
 Type *TypeFactory::getFloat() { 
-    return makePrimitive(TypeKind::Float, 4); 
+    static Type *const type = makePrimitive(TypeKind::Float, 4);
+    return type;
 }
 
 Type *TypeFactory::getChar() { 
-    return makePrimitive(TypeKind::Char, 1); 
+    static Type *const type = makePrimitive(TypeKind::Char, 1);
+    return type;
 }
 
 Type *TypeFactory::getBool() { 
-    return makePrimitive(TypeKind::Bool, 1); 
+    static Type *const type = makePrimitive(TypeKind::Bool, 1);
+    return type;
 }
 
-Type *TypeFactory::getArray() {
-    typePool.push_back(new ArrayType());
-    return typePool.back();
+Type *TypeFactory::primitive(TypeKind kind) {
+    switch(kind) {
+        case TypeKind::Void: return getVoid();
+        case TypeKind::Int: return getInt();
+        case TypeKind::Float: return getFloat();
+        case TypeKind::Char: return getChar();
+        case TypeKind::Bool: return getBool();
+        default:
+            std::cout << "not a primitive type at TypeFactory::primitive\n";
+            exit(1);
+    }
 }
 
-ClassVarType *TypeFactory::getClassVar(std::string classname) {
-    typePool.push_back(new ClassVarType(classname));
-    return dynamic_cast<ClassVarType*>(typePool.back());
+ArrayType *TypeFactory::getArrayOf(struct Type *element, const std::vector<size_t> &dims) {
+    element = canonical(element);
+    return static_cast<ArrayType*>(intern({.kind = TypeKind::Array, .element = element, .dims = &dims}, [&] {
+        ArrayType *a = new ArrayType();
+        a->element_type = element;
+        a->dims = dims;
+        return a;
+    }));
 }
 
-PointerType *TypeFactory::getPointer() {
-    typePool.push_back(new PointerType());
-    return dynamic_cast<PointerType*>(typePool.back());
+ClassVarType *TypeFactory::getClassVar(std::string classname) {
+    return static_cast<ClassVarType*>(intern({.kind = TypeKind::ClassVar, .classSym = Interner::intern(classname)},
+        [&] { return new ClassVarType(classname); }));
 }
 
-PointerType *TypeFactory::getPointerTo(struct Type* ptr) {
-    PointerType *p = new PointerType();
-    if(ptr->kind == TypeKind::Pointer) {
-        PointerType *pointer = dynamic_cast<PointerType*>(ptr);
-        p->elementType = pointer->elementType;
-        p->depth = pointer->depth + 1;
-    } else {
-        p->elementType = ptr;
+PointerType *TypeFactory::getPointerTo(struct Type* ptr, size_t depth) {
+    Type *element = ptr;
+    if(ptr != nullptr && ptr->kind == TypeKind::Pointer) {
+        PointerType *pointer = static_cast<PointerType*>(ptr);
+        element = pointer->elementType;
+        depth += pointer->depth;
     }
-    typePool.push_back(p);
-    return dynamic_cast<PointerType*>(typePool.back());
+    element = canonical(element);
+    return static_cast<PointerType*>(intern({.kind = TypeKind::Pointer, .element = element, .depth = depth}, [&] {
+        PointerType *p = new PointerType();
+        p->elementType = element;
+        p->depth = depth;
+        return p;
+    }));
 }
 
 FuncType *TypeFactory::getFunction() {
-    typePool.push_back(new FuncType());
-    return dynamic_cast<FuncType*>(typePool.back());
+    FuncType *type = new FuncType();
+    std::lock_guard<std::mutex> guard(lock);
+    typePool.push_back(type);
+    return type;
+}
+
+// The canonical type of the same structure as type, which is left as is. Types that are
+// not complete yet (arrays with pending dims) and those that are never shared are returned
+// unchanged.
+Type *TypeFactory::canonical(struct Type *type) {
+    if(type == nullptr || type->unqualified != nullptr) return type;
+    switch(type->kind) {
+        case TypeKind::Int: case TypeKind::Bool: case TypeKind::Char:
+        case TypeKind::Float: case TypeKind::Void:
+            return type->is_const ? getConst(primitive(type->kind)) : primitive(type->kind);
+        case TypeKind::Array: {
+            ArrayType *array = static_cast<ArrayType*>(type);
+            if(!array->pendingDims.empty()) return type;
+            Type *element = canonical(array->element_type);
+            return intern({.kind = TypeKind::Array, .is_const = type->is_const, .size = type->size,
+                           .element = element, .dims = &array->dims}, [&] {
+                ArrayType *a = new ArrayType();
+                a->element_type = element;
+                a->dims = array->dims;
+                return a;
+            });
+        }
+        case TypeKind::Pointer: {
+            PointerType *pointer = static_cast<PointerType*>(type);
+            Type *element = canonical(pointer->elementType);
+            return intern({.kind = TypeKind::Pointer, .is_const = type->is_const, .size = type->size,
+                           .element = element, .depth = pointer->depth}, [&] {
+                PointerType *p = new PointerType();
+                p->elementType = element;
+                p->depth = pointer->depth;
+                return p;
+            });
+        }
+        case TypeKind::ClassVar: {
+            ClassVarType *classVar = static_cast<ClassVarType*>(type);
+            return intern({.kind = TypeKind::ClassVar, .is_const = type->is_const, .size = type->size,
+                           .classSym = classVar->classSym}, [&] { return new ClassVarType(classVar->classname); });
+        }
+        default:
+            return type;
+    }
 }
 
-Type *TypeFactory::makePrimitive(TypeKind kind, size_t size) {
-    if(primitives.find(kind) == primitives.end()) {
-        primitives[kind] = new PrimitiveType(kind, size);
+// The canonical type with const added, as setConst would: for an array on its elements.
+Type *TypeFactory::getConst(struct Type *type) {
+    type = canonical(type);
+    if(type == nullptr || type->is_const) return type;
+    switch(type->kind) {
+        case TypeKind::Int: case TypeKind::Bool: case TypeKind::Char:
+        case TypeKind::Float: case TypeKind::Void:
+            return intern({.kind = type->kind, .is_const = true, .size = type->size},
+                [&] { return new PrimitiveType(type->kind, type->size); });
+        case TypeKind::Array: {
+            ArrayType *array = static_cast<ArrayType*>(type);
+            return getArrayOf(getConst(array->element_type), array->dims);
+        }
+        case TypeKind::Pointer: {
+            PointerType *pointer = static_cast<PointerType*>(type);
+            return intern({.kind = TypeKind::Pointer, .is_const = true, .size = type->size,
+                           .element = pointer->elementType, .depth = pointer->depth}, [&] {
+                PointerType *p = new PointerType();
+                p->elementType = pointer->elementType;
+                p->depth = pointer->depth;
+                return p;
+            });
+        }
+        case TypeKind::ClassVar: {
+            ClassVarType *classVar = static_cast<ClassVarType*>(type);
+            return intern({.kind = TypeKind::ClassVar, .is_const = true, .size = type->size,
+                           .classSym = classVar->classSym}, [&] { return new ClassVarType(classVar->classname); });
+        }
+        default: // not shared, so it can be changed
+            type->setConst();
+            return type;
     }
-    return primitives[kind];
 }
 
-void TypeFactory::deleteAll() {
-    for(auto ptr : primitives) {
-        delete ptr.second;
+bool TypeFactory::typeKey::operator==(const typeKey &other) const {
+    return kind == other.kind && is_const == other.is_const && size == other.size && element == other.element
+        && depth == other.depth && classSym == other.classSym
+        && (dims == other.dims || (dims != nullptr && other.dims != nullptr && *dims == *other.dims));
+}
+
+// The parts of a key are canonical, so they are hashed by address.
+size_t TypeFactory::typeKeyHash::operator()(const typeKey &key) const {
+    uint64_t hash = 0;
+    auto add = [&hash](uint64_t word) { hash ^= word + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2); };
+    add(key.kind);
+    add(key.is_const);
+    add(key.size);
+    add(reinterpret_cast<uintptr_t>(key.element));
+    add(key.depth);
+    add(key.classSym);
+    if(key.dims != nullptr) {
+        for(size_t dim : *key.dims) add(dim);
+    }
+    return hash;
+}
+
+// The key of a canonical type, pointing into the type's own dims.
+TypeFactory::typeKey TypeFactory::keyOf(struct Type *type) {
+    typeKey key = {.kind = type->kind, .is_const = type->is_const, .size = type->size};
+    if(type->kind == TypeKind::Array) {
+        ArrayType *array = static_cast<ArrayType*>(type);
+        key.element = array->element_type;
+        key.dims = &array->dims;
+    } else if(type->kind == TypeKind::Pointer) {
+        PointerType *pointer = static_cast<PointerType*>(type);
+        key.element = pointer->elementType;
+        key.depth = pointer->depth;
+    } else if(type->kind == TypeKind::ClassVar) {
+        key.classSym = static_cast<ClassVarType*>(type)->classSym;
+    }
+    return key;
+}
+
+// The canonical type without any const of a new canonical type, which is the type itself
+// if it has no const. An array or pointer of an element that is not canonical (a class or
+// error type, an array with pending dims) has none, so sameAs compares it with equals.
+Type *TypeFactory::unqualifiedOf(struct Type *type) {
+    if(type->kind == TypeKind::Array) {
+        ArrayType *array = static_cast<ArrayType*>(type);
+        Type *element = array->element_type ? array->element_type->unqualified : nullptr;
+        if(array->element_type && !element) return nullptr;
+        if(!type->is_const && element == array->element_type) return type;
+        return intern({.kind = TypeKind::Array, .size = type->size, .element = element, .dims = &array->dims}, [&] {
+            ArrayType *a = new ArrayType();
+            a->element_type = element;
+            a->dims = array->dims;
+            return a;
+        });
+    } else if(type->kind == TypeKind::Pointer) {
+        PointerType *pointer = static_cast<PointerType*>(type);
+        Type *element = pointer->elementType ? pointer->elementType->unqualified : nullptr;
+        if(pointer->elementType && !element) return nullptr;
+        if(!type->is_const && element == pointer->elementType) return type;
+        return intern({.kind = TypeKind::Pointer, .size = type->size, .element = element, .depth = pointer->depth}, [&] {
+            PointerType *p = new PointerType();
+            p->elementType = element;
+            p->depth = pointer->depth;
+            return p;
+        });
+    } else if(!type->is_const) {
+        return type;
+    } else if(type->kind == TypeKind::ClassVar) {
+        ClassVarType *classVar = static_cast<ClassVarType*>(type);
+        return intern({.kind = TypeKind::ClassVar, .size = type->size, .classSym = classVar->classSym},
+            [&] { return new ClassVarType(classVar->classname); });
+    }
+    return primitive(type->kind);
+}
+
+// Returns the canonical type with the given key, building it with make (and then giving it
+// the const and size of the key) if there is none yet. A new type is completed, unqualified
+// type included, before it is published under the lock, as other threads read it without
+// one; if another thread published the same type meanwhile, that one is kept.
+template<class Make>
+Type *TypeFactory::intern(const typeKey &key, Make make) {
+    uint64_t current = generation.load(std::memory_order_acquire);
+    if(seenGeneration != current) {
+        seenTypes.clear();
+        seenGeneration = current;
     }
+    auto seen = seenTypes.find(key);
+    if(seen != seenTypes.end()) {
+        return seen->second;
+    }
+
+    Type *type = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = canonicalTypes.find(key);
+        if(found != canonicalTypes.end()) type = found->second;
+    }
+    if(type == nullptr) {
+        Type *candidate = make();
+        candidate->is_const = key.is_const;
+        candidate->size = key.size;
+        candidate->unqualified = unqualifiedOf(candidate);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto inserted = canonicalTypes.emplace(keyOf(candidate), candidate);
+            if(inserted.second) typePool.push_back(candidate);
+            type = inserted.first->second;
+        }
+        if(type != candidate) delete candidate;
+    }
+    seenTypes.emplace(keyOf(type), type);
+    return type;
+}
+
+size_t TypeFactory::canonicalCount() {
+    std::lock_guard<std::mutex> guard(lock);
+    return 5 + canonicalTypes.size(); // and the primitive types
+}
+
+// Frees the canonical and function types; the primitive types live for the whole run.
+void TypeFactory::deleteAll() {
+    std::lock_guard<std::mutex> guard(lock);
     for(auto ptr : typePool) {
         delete ptr;
     }
+    typePool.clear();
+    canonicalTypes.clear();
+    generation.fetch_add(1, std::memory_order_release);
 }
 
-std::map<TypeKind,Type*> TypeFactory::primitives;
-std::vector<Type*> TypeFactory::typePool;
\ No newline at end of file
+std::vector<Type*> TypeFactory::typePool;
+TypeFactory::typeTable TypeFactory::canonicalTypes;
+std::mutex TypeFactory::lock;
+std::atomic<uint64_t> TypeFactory::generation(0);
+thread_local TypeFactory::typeTable TypeFactory::seenTypes;
+thread_local uint64_t TypeFactory::seenGeneration = 0;